@@ -0,0 +1,134 @@
+// ----------------------------------
+// projects/deque/AlignedAllocator.h
+// ----------------------------------
+
+#ifndef AlignedAllocator_h
+#define AlignedAllocator_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef>  // ptrdiff_t, size_t
+#include <cstdlib>  // free
+#include <new>      // bad_alloc
+#include <utility>  // forward
+
+#ifdef _WIN32
+#include <malloc.h> // _aligned_free, _aligned_malloc
+#else
+#include <stdlib.h> // posix_memalign
+#endif
+
+// -----------------
+// aligned_allocator
+// -----------------
+
+/**
+ * an allocator whose blocks start on an N byte boundary and are padded to a multiple of N bytes
+ *
+ * With N the cache line size (64) a MyDeque block never shares a line with anything else and its
+ * first element starts a line, so a walk over a block touches the fewest lines it can.
+ * N may also be the page size. N must be a power of two and at least sizeof(void*).
+ */
+template <typename T, std::size_t N = 64>
+class aligned_allocator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+
+        template <typename U>
+        struct rebind {
+            typedef aligned_allocator<U, N> other;
+        };
+
+        static const std::size_t alignment = N;
+
+    public:
+        friend bool operator == (const aligned_allocator&, const aligned_allocator&) {
+            return true;
+        }
+
+        friend bool operator != (const aligned_allocator&, const aligned_allocator&) {
+            return false;
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        aligned_allocator ()
+            {}
+
+        template <typename U>
+        aligned_allocator (const aligned_allocator<U, N>&)
+            {}
+
+        // Default copy, destructor, and copy assignment.
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+         * @param n a size_type
+         * @return a pointer to room for n values, aligned to and padded out to N bytes
+         */
+        pointer allocate (size_type n) {
+            std::size_t b = (n * sizeof(T) + N - 1) / N * N;
+            void*       p = 0;
+#ifdef _WIN32
+            p = _aligned_malloc(b ? b : N, N);
+#else
+            if (posix_memalign(&p, N, b ? b : N)) {
+                p = 0;
+            }
+#endif
+            if (!p) {
+                throw std::bad_alloc();
+            }
+            return static_cast<pointer>(p);
+        }
+
+        // ----------
+        // deallocate
+        // ----------
+
+        void deallocate (pointer p, size_type) {
+#ifdef _WIN32
+            _aligned_free(p);
+#else
+            std::free(p);
+#endif
+        }
+
+        // ---------
+        // construct
+        // ---------
+
+        template <typename U, typename... Args>
+        void construct (U* p, Args&&... args) {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        // -------
+        // destroy
+        // -------
+
+        template <typename U>
+        void destroy (U* p) {
+            p->~U();
+        }
+};
+
+#endif // AlignedAllocator_h
@@ -0,0 +1,333 @@
+// ----------------------------
+// projects/deque/AsyncDeque.h
+// ----------------------------
+
+#ifndef AsyncDeque_h
+#define AsyncDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // min
+#include <cassert>   // assert
+#include <memory>    // allocator
+#include <utility>   // move
+
+#include "Deque.h"
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <coroutine> // coroutine_handle
+#include <iterator>  // back_inserter
+#include <optional>  // nullopt, optional
+#include <vector>    // vector
+
+// ------------
+// MyAsyncDeque
+// ------------
+
+/**
+ * a MyDeque that coroutines can wait on, for C++20
+ *
+ * co_await pop_front() suspends the coroutine until an element is there, and co_await
+ * pop_front_n(n) until n are there. A waiting coroutine is queued on a list threaded through the
+ * awaiter in its own frame, so waiting costs no thread and no allocation. push_back hands elements
+ * to the waiters in the order they started waiting and resumes them directly, on the pushing
+ * thread, before it returns. Like MyDeque it is meant for one thread, such as an event loop.
+ *
+ * close stops further pushes and wakes every waiter; pops then drain what is left and after
+ * that come back empty. cancel does the same but throws away what is left.
+ * A coroutine must not be destroyed while it waits, and the MyAsyncDeque must outlive its waiters.
+ */
+template < typename T, typename A = std::allocator<T> >
+class MyAsyncDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef MyDeque<T, A>                        container_type;
+        typedef typename container_type::value_type  value_type;
+        typedef typename container_type::size_type   size_type;
+
+    private:
+        // ------
+        // waiter
+        // ------
+
+        /**
+         * a suspended pop, linked into the list of waiters
+         */
+        struct waiter {
+            MyAsyncDeque*           q;
+            size_type               need;   // elements it waits for
+            waiter*                 next;
+            std::coroutine_handle<> h;
+
+            waiter (MyAsyncDeque* x, size_type n) :
+                    q (x), need (n), next (0)
+                {}
+
+            /**
+             * takes what it waited for from q before h is resumed
+             */
+            virtual void take () = 0;
+        };
+
+        // ----
+        // data
+        // ----
+
+        container_type _x;
+        waiter*        _first;  // longest waiting
+        waiter*        _last;
+        size_type      _waiting;
+        bool           _closed;
+
+    private:
+        // -----
+        // enter
+        // -----
+
+        void enter (waiter* w) {
+            if (_last) {
+                _last->next = w;
+            }
+            else {
+                _first = w;
+            }
+            _last = w;
+            ++_waiting;
+        }
+
+        // --------
+        // dispatch
+        // --------
+
+        /**
+         * resumes waiters, longest waiting first, while the first one can be satisfied
+         * a resumed coroutine may push, pop or wait again before this carries on
+         */
+        void dispatch () {
+            while (_first && (_closed || _x.size() >= _first->need)) {
+                waiter* w = _first;
+                _first = w->next;
+                if (!_first) {
+                    _last = 0;
+                }
+                --_waiting;
+                w->take();
+                w->h.resume();
+            }
+        }
+
+    public:
+        // -----------
+        // pop_awaiter
+        // -----------
+
+        /**
+         * what co_await pop_front() waits on, giving an optional that is empty once the queue is
+         * closed and drained
+         */
+        class pop_awaiter : private waiter {
+            friend class MyAsyncDeque;
+
+            private:
+                std::optional<value_type> v;
+
+                explicit pop_awaiter (MyAsyncDeque* x) :
+                        waiter (x, 1)
+                    {}
+
+                void take () {
+                    if (!this->q->_x.empty()) {
+                        v.emplace(std::move(this->q->_x.front()));
+                        this->q->_x.pop_front();
+                    }
+                }
+
+            public:
+                bool await_ready () {
+                    if (this->q->_first || (this->q->_x.empty() && !this->q->_closed)) {
+                        return false;
+                    }
+                    take();
+                    return true;
+                }
+
+                void await_suspend (std::coroutine_handle<> h) {
+                    this->h = h;
+                    this->q->enter(this);
+                }
+
+                std::optional<value_type> await_resume () {
+                    return std::move(v);
+                }
+        };
+
+        // -------------
+        // pop_n_awaiter
+        // -------------
+
+        /**
+         * what co_await pop_front_n(n) waits on, giving a vector of n elements, or of fewer once
+         * the queue is closed, down to none once it is drained
+         */
+        class pop_n_awaiter : private waiter {
+            friend class MyAsyncDeque;
+
+            private:
+                std::vector<value_type> v;
+
+                pop_n_awaiter (MyAsyncDeque* x, size_type n) :
+                        waiter (x, n)
+                    {}
+
+                void take () {
+                    size_type n = std::min(this->need, this->q->_x.size());
+                    v.reserve(n);
+                    this->q->_x.drain_front_into(std::back_inserter(v), n);
+                }
+
+            public:
+                bool await_ready () {
+                    if (this->q->_first || (this->q->_x.size() < this->need && !this->q->_closed)) {
+                        return false;
+                    }
+                    take();
+                    return true;
+                }
+
+                void await_suspend (std::coroutine_handle<> h) {
+                    this->h = h;
+                    this->q->enter(this);
+                }
+
+                std::vector<value_type> await_resume () {
+                    return std::move(v);
+                }
+        };
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        explicit MyAsyncDeque (const A& a = A()) :
+                _x (a), _first (0), _last (0), _waiting (0), _closed (false)
+            {}
+
+        MyAsyncDeque (const MyAsyncDeque&) = delete;
+        MyAsyncDeque& operator = (const MyAsyncDeque&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~MyAsyncDeque () {
+            assert(!_first);
+        }
+
+        // ------
+        // cancel
+        // ------
+
+        /**
+         * closes the queue and throws away the elements left in it
+         */
+        void cancel () {
+            _x.clear();
+            close();
+        }
+
+        // -----
+        // close
+        // -----
+
+        /**
+         * stops further pushes and resumes every waiter with what is left
+         */
+        void close () {
+            _closed = true;
+            dispatch();
+        }
+
+        // ------
+        // closed
+        // ------
+
+        bool closed () const {
+            return _closed;
+        }
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return _x.empty();
+        }
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * @return an awaiter giving the first element, once there is one
+         */
+        pop_awaiter pop_front () {
+            return pop_awaiter(this);
+        }
+
+        /**
+         * @param n a size_type, more than 0
+         * @return an awaiter giving the first n elements, once there are n
+         */
+        pop_n_awaiter pop_front_n (size_type n) {
+            assert(n);
+            return pop_n_awaiter(this, n);
+        }
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param v a value_type
+         * @return a bool, false if the queue is closed
+         * adds v after the last element and resumes the waiters it satisfies
+         */
+        bool push_back (value_type v) {
+            if (_closed) {
+                return false;
+            }
+            _x.push_back(std::move(v));
+            dispatch();
+            return true;
+        }
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _x.size();
+        }
+
+        // -------
+        // waiting
+        // -------
+
+        /**
+         * @return the number of suspended pops
+         */
+        size_type waiting () const {
+            return _waiting;
+        }
+};
+
+#endif // C++20 coroutines
+
+#endif // AsyncDeque_h
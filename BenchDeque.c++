@@ -0,0 +1,1079 @@
+/*
+ * BenchDeque
+ *
+ * To compile this, use the command
+ * g++ -pedantic -std=c++0x -Wall -O3 -DNDEBUG BenchDeque.c++ -o BenchDeque -lpthread
+ *
+ * Then it can run with
+ * BenchDeque [section] [n]
+ *
+ * With no arguments every section runs with its default size
+ */
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // sort
+#include <chrono>    // steady_clock
+#include <climits>   // IOV_MAX
+#include <cstdlib>   // atol, rand
+#include <cstring>   // strcmp
+#include <deque>     // deque
+#include <iostream>  // cout, endl
+#include <string>    // string, to_string
+#include <thread>    // hardware_concurrency
+#include <vector>    // vector
+
+#ifdef __linux__
+#include <linux/perf_event.h> // perf_event_attr
+#include <sys/ioctl.h>        // ioctl
+#include <sys/syscall.h>      // SYS_perf_event_open
+#include <sys/uio.h>          // iovec, readv, writev
+#include <unistd.h>           // close, pipe, read, syscall, write
+#endif
+#include "AlignedAllocator.h"
+#include "ByteBuffer.h"
+#include "Deque.h"
+#include "HugePageAllocator.h"
+#include "PackedDeque.h"
+#include "SlidingWindow.h"
+#include "SoaDeque.h"
+#include "SortedDeque.h"
+#include "TieredDeque.h"
+
+using namespace std;
+
+// -------
+// elapsed
+// -------
+
+/**
+ * @param b a time point
+ * @return the milliseconds since b
+ */
+double elapsed (chrono::steady_clock::time_point b) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - b).count();
+}
+
+// ----------
+// bench_sort
+// ----------
+
+/**
+ * @param n a size
+ * times MyDeque::sort against std::sort on a std::vector holding the same values
+ */
+void bench_sort (size_t n) {
+    vector<int> v(n);
+    for (size_t i = 0; i != n; ++i) {
+        v[i] = rand();
+    }
+
+    MyDeque<int> x(n);
+    std::copy(v.begin(), v.end(), x.begin());
+    MyDeque<int> y(x);
+
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    std::sort(v.begin(), v.end());
+    cout << "sort " << n << " std::sort vector       " << elapsed(b) << " ms" << endl;
+
+    b = chrono::steady_clock::now();
+    x.sort();
+    cout << "sort " << n << " MyDeque::sort          " << elapsed(b) << " ms" << endl;
+
+    size_t threads = max(1u, thread::hardware_concurrency());
+    b = chrono::steady_clock::now();
+    y.sort(less<int>(), threads);
+    cout << "sort " << n << " MyDeque::sort x" << threads << "       " << elapsed(b) << " ms" << endl;
+
+    if (!std::equal(v.begin(), v.end(), x.begin()) || !std::equal(v.begin(), v.end(), y.begin())) {
+        cout << "sort " << n << " MISMATCH" << endl;
+    }
+}
+
+// ------------
+// bench_window
+// ------------
+
+/**
+ * @param n a size
+ * times a rolling min/max over a window of the last 1000 ticks, kept by MySlidingMinMax
+ * against rescanning a MyDeque on every tick
+ */
+void bench_window (size_t n) {
+    const long long w = 1000;
+    vector<int> v(n);
+    for (size_t i = 0; i != n; ++i) {
+        v[i] = rand();
+    }
+
+    long long sum = 0;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    MyDeque< pair<int, long long> > x;
+    for (size_t t = 0; t != n; ++t) {
+        x.push_back(make_pair(v[t], (long long) t));
+        while (x.front().second < (long long) t - w) {
+            x.pop_front();
+        }
+        int lo = x.front().first;
+        int hi = lo;
+        for (MyDeque< pair<int, long long> >::iterator p = x.begin(); p != x.end(); ++p) {
+            lo = min(lo, p->first);
+            hi = max(hi, p->first);
+        }
+        sum += hi - lo;
+    }
+    cout << "window " << n << " rescan MyDeque       " << elapsed(b) << " ms" << endl;
+
+    long long check = 0;
+    b = chrono::steady_clock::now();
+    MySlidingMinMax<int> y;
+    for (size_t t = 0; t != n; ++t) {
+        y.push(v[t], t);
+        y.expire_before((long long) t - w);
+        check += y.max() - y.min();
+    }
+    cout << "window " << n << " MySlidingMinMax      " << elapsed(b) << " ms" << endl;
+
+    if (sum != check) {
+        cout << "window " << n << " MISMATCH" << endl;
+    }
+}
+
+// --------------
+// bench_snapshot
+// --------------
+
+/**
+ * @param n a size
+ * times copying a MyDeque of n elements with and without copy_on_write
+ */
+void bench_snapshot (size_t n) {
+    MyDeque<int> x(n, 1);
+
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (int i = 0; i != 10; ++i) {
+        MyDeque<int> y(x);
+    }
+    cout << "snapshot " << n << " deep copy            " << elapsed(b) / 10 << " ms" << endl;
+
+    x.copy_on_write(true);
+    MyDeque<int> warm(x);
+    b = chrono::steady_clock::now();
+    for (int i = 0; i != 10; ++i) {
+        MyDeque<int> y(x);
+    }
+    cout << "snapshot " << n << " copy_on_write        " << elapsed(b) / 10 << " ms" << endl;
+}
+
+// -----------
+// bench_index
+// -----------
+
+/**
+ * @param n a size
+ * times random reads through operator [] against std::deque, and through gather
+ */
+void bench_index (size_t n) {
+    MyDeque<int> x;
+    deque<int>   y;
+    for (size_t i = 0; i != n; ++i) {
+        x.push_front((int) i);
+        y.push_front((int) i);
+    }
+    vector<size_t> index(n);
+    for (size_t i = 0; i != n; ++i) {
+        index[i] = ((size_t) rand() * RAND_MAX + rand()) % n;
+    }
+
+    long long sum = 0;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t i = 0; i != n; ++i) {
+        sum += y[index[i]];
+    }
+    cout << "index " << n << " std::deque []         " << elapsed(b) << " ms" << endl;
+
+    long long check = 0;
+    const MyDeque<int>& c = x;
+    b = chrono::steady_clock::now();
+    for (size_t i = 0; i != n; ++i) {
+        check += c[index[i]];
+    }
+    cout << "index " << n << " MyDeque []            " << elapsed(b) << " ms" << endl;
+
+    vector<int> out(n);
+    b = chrono::steady_clock::now();
+    c.gather(index.begin(), index.end(), out.begin());
+    cout << "index " << n << " MyDeque gather        " << elapsed(b) << " ms" << endl;
+
+    long long gathered = 0;
+    for (size_t i = 0; i != n; ++i) {
+        gathered += out[i];
+    }
+    if ((sum != check) || (sum != gathered)) {
+        cout << "index " << n << " MISMATCH" << endl;
+    }
+}
+
+// ------------
+// bench_tiered
+// ------------
+
+/**
+ * @param n a size
+ * times inserting and erasing in the middle of n elements, MyDeque against MyTieredDeque
+ */
+void bench_tiered (size_t n) {
+    const size_t edits = 500;
+    MyDeque<int>       x(n, 1);
+    MyTieredDeque<int> y(n, 1);
+
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t i = 0; i != edits; ++i) {
+        x.insert(x.begin() + x.size() / 2, (int) i);
+        x.erase(x.begin() + x.size() / 3);
+    }
+    cout << "tiered " << n << " MyDeque middle edits   " << elapsed(b) << " ms" << endl;
+
+    b = chrono::steady_clock::now();
+    for (size_t i = 0; i != edits; ++i) {
+        y.insert(y.begin() + y.size() / 2, (int) i);
+        y.erase(y.begin() + y.size() / 3);
+    }
+    cout << "tiered " << n << " MyTieredDeque edits    " << elapsed(b) << " ms" << endl;
+
+    long long sum = 0;
+    b = chrono::steady_clock::now();
+    for (size_t i = 0; i != n; ++i) {
+        sum += y[(i * 7919) % n];
+    }
+    cout << "tiered " << n << " MyTieredDeque []       " << elapsed(b) << " ms" << endl;
+
+    for (size_t i = 0; i != n; ++i) {
+        sum -= x[(i * 7919) % n];
+    }
+    if (sum || !equal(x.begin(), x.end(), y.begin())) {
+        cout << "tiered " << n << " MISMATCH" << endl;
+    }
+}
+
+// ---------
+// bench_soa
+// ---------
+
+struct quote {
+    double bid;
+    double ask;
+    double last;
+    double volume;
+    long long time;
+    long long id;
+    int venue;
+    int flags;
+    long long seq;
+};
+
+struct sum_segment {
+    double s;
+    sum_segment () : s (0) {}
+    void operator () (const double* b, const double* e) {
+        while (b != e) {
+            s += *b++;
+        }
+    }
+};
+
+/**
+ * @param n a size
+ * times summing one field of n records stored whole in a MyDeque and field by field in a soa_deque
+ */
+void bench_soa (size_t n) {
+    MyDeque<quote> x;
+    soa_deque<double, double, double, double, long long, long long, int, int, long long> y;
+    for (size_t i = 0; i != n; ++i) {
+        quote q = {(double) i, i + 0.5, (double) i, 100.0, (long long) i, (long long) i, 1, 0, (long long) i};
+        x.push_back(q);
+        y.push_back(q.bid, q.ask, q.last, q.volume, q.time, q.id, q.venue, q.flags, q.seq);
+    }
+
+    const MyDeque<quote>& c = x;
+    double sum = 0;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (MyDeque<quote>::const_iterator p = c.begin(); p != c.end(); ++p) {
+        sum += p->bid;
+    }
+    cout << "soa " << n << " MyDeque<quote> scan      " << elapsed(b) << " ms" << endl;
+
+    b = chrono::steady_clock::now();
+    double check = y.for_each_segment<0>(sum_segment()).s;
+    cout << "soa " << n << " soa_deque field scan     " << elapsed(b) << " ms" << endl;
+
+    if (sum != check) {
+        cout << "soa " << n << " MISMATCH" << endl;
+    }
+}
+
+// -----------
+// tlb_counter
+// -----------
+
+/**
+ * counts the data TLB misses of this thread while it is running, if the kernel lets it
+ */
+class tlb_counter {
+    private:
+        int _fd;
+
+    public:
+        tlb_counter () :
+                _fd (-1) {
+#ifdef __linux__
+            perf_event_attr a = perf_event_attr();
+            a.size           = sizeof(a);
+            a.type           = PERF_TYPE_HW_CACHE;
+            a.config         = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            a.disabled       = 1;
+            a.exclude_kernel = 1;
+            a.exclude_hv     = 1;
+            _fd = syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+            if (_fd != -1) {
+                ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        ~tlb_counter () {
+#ifdef __linux__
+            if (_fd != -1) {
+                close(_fd);
+            }
+#endif
+        }
+
+        /**
+         * @return the misses so far, or -1 if they can't be counted here
+         */
+        long long misses () const {
+            long long n = -1;
+#ifdef __linux__
+            if (_fd == -1 || read(_fd, &n, sizeof(n)) != sizeof(n)) {
+                return -1;
+            }
+#endif
+            return n;
+        }
+};
+
+// --------------
+// bench_hugepage
+// --------------
+
+/**
+ * @param m a count of misses, or -1
+ * @return m, or n/a when it couldn't be counted
+ */
+string misses (long long m) {
+    return (m < 0) ? string("n/a") : to_string(m);
+}
+
+/**
+ * @param x a MyDeque
+ * @param name a label
+ * times a sequential and a random pass over x, with the data TLB misses of each
+ */
+template <typename D>
+void traverse (const D& x, const char* name) {
+    const size_t n = x.size();
+    long long sum = 0;
+    double    t;
+    long long m;
+    {
+        tlb_counter c;
+        chrono::steady_clock::time_point b = chrono::steady_clock::now();
+        for (typename D::const_iterator p = x.begin(); p != x.end(); ++p) {
+            sum += *p;
+        }
+        t = elapsed(b);
+        m = c.misses();
+    }
+    cout << "hugepage " << name << " sequential " << t << " ms, dTLB misses " << misses(m) << endl;
+
+    const size_t reads = 10000000;
+    size_t       i     = 12345;
+    {
+        tlb_counter c;
+        chrono::steady_clock::time_point b = chrono::steady_clock::now();
+        for (size_t k = 0; k != reads; ++k) {
+            i = (i * 6364136223846793005ULL + 1442695040888963407ULL);
+            sum += x[(i >> 17) % n];
+        }
+        t = elapsed(b);
+        m = c.misses();
+    }
+    cout << "hugepage " << name << " random     " << t << " ms, dTLB misses " << misses(m) << endl;
+    if (!sum) {
+        cout << "hugepage " << name << " MISMATCH" << endl;
+    }
+}
+
+/**
+ * @param n a size
+ * fills a MyDeque of n ints from the heap and from huge pages and traverses each
+ */
+void bench_hugepage (size_t n) {
+    cout << "hugepage " << n * sizeof(int) / (1 << 20) << " MiB of int" << endl;
+    {
+        MyDeque<int> x;
+        for (size_t i = 0; i != n; ++i) {
+            x.push_back((int) i);
+        }
+        traverse(x, "std::allocator     ");
+    }
+    {
+        MyDeque<int, huge_page_allocator<int> > x;
+        for (size_t i = 0; i != n; ++i) {
+            x.push_back((int) i);
+        }
+        traverse(x, "huge_page_allocator");
+    }
+    {
+        huge_page_allocator<int> a(true);
+        MyDeque<int, huge_page_allocator<int> > x(a);
+        for (size_t i = 0; i != n; ++i) {
+            x.push_back((int) i);
+        }
+        traverse(x, "huge_page + mbind  ");
+        cout << "hugepage " << a.arena().regions() << " regions, " << a.arena().hinted() << " took MADV_HUGEPAGE" << endl;
+    }
+}
+
+// -------------
+// bench_aligned
+// -------------
+
+struct sum_ints {
+    long long s;
+    sum_ints () : s (0) {}
+    void operator () (const int* b, const int* e) {
+        while (b != e) {
+            s += *b++;
+        }
+    }
+};
+
+/**
+ * @param x an empty MyDeque
+ * @param n a size
+ * fills x with n ints from a heap that handed out and took back blocks in random order, the way a
+ * long running process's heap does, then times cold passes over x through its iterators and
+ * through for_each_segment
+ */
+template <typename D>
+void cold_scan (D& x, size_t n, const char* name) {
+    typename D::allocator_type a;
+    vector<int*> junk(2 * (n / BLOCK_WIDTH + 1));
+    for (size_t k = 0; k != junk.size(); ++k) {
+        junk[k] = a.allocate(BLOCK_WIDTH);
+    }
+    vector<int*> holes;
+    for (size_t k = 1; k < junk.size(); k += 2) {
+        holes.push_back(junk[k]);
+    }
+    random_shuffle(holes.begin(), holes.end());
+    for (size_t k = 0; k != holes.size(); ++k) {
+        a.deallocate(holes[k], BLOCK_WIDTH);
+    }
+    for (size_t i = 0; i != n; ++i) {
+        x.push_back((int) i);
+    }
+    vector<char> flush(64 << 20);
+
+    for (size_t k = 0; k != flush.size(); k += 64) {
+        ++flush[k];
+    }
+    const D&  c   = x;
+    long long sum = 0;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (typename D::const_iterator p = c.begin(); p != c.end(); ++p) {
+        sum += *p;
+    }
+    cout << "aligned " << name << " iterator scan " << elapsed(b) << " ms" << endl;
+
+    for (size_t k = 0; k != flush.size(); k += 64) {
+        ++flush[k];
+    }
+    b = chrono::steady_clock::now();
+    long long check = c.for_each_segment(sum_ints()).s;
+    cout << "aligned " << name << " segment scan  " << elapsed(b) << " ms" << endl;
+
+    if (sum != check) {
+        cout << "aligned " << name << " MISMATCH" << endl;
+    }
+    for (size_t k = 0; k < junk.size(); k += 2) {
+        a.deallocate(junk[k], BLOCK_WIDTH);
+    }
+}
+
+/**
+ * @param n a size
+ * times cold scans of n ints in heap blocks and in cache-line-aligned blocks
+ */
+void bench_aligned (size_t n) {
+    {
+        MyDeque<int> x;
+        cold_scan(x, n, "std::allocator       ");
+    }
+    {
+        MyDeque<int, aligned_allocator<int> > x;
+        cold_scan(x, n, "aligned_allocator<64>");
+    }
+}
+
+// -----------
+// bench_batch
+// -----------
+
+/**
+ * @param n a size
+ * @param v a value
+ * times draining a MyDeque of n copies of v in batches of 256, one pop_front at a time and through
+ * drain_front_into
+ */
+template <typename T>
+void batch_drain (size_t n, const T& v, const char* name) {
+    const size_t batch = 256;
+    MyDeque<T>   x;
+    vector<T>    out;
+    out.reserve(batch);
+
+    for (size_t i = 0; i != n; ++i) {
+        x.push_back(v);
+    }
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    while (!x.empty()) {
+        size_t m = min(batch, x.size());
+        out.clear();
+        for (size_t i = 0; i != m; ++i) {
+            out.push_back(std::move(x.front()));
+            x.pop_front();
+        }
+    }
+    double t = elapsed(b);
+    cout << "batch " << name << " pop_front        " << t << " ms, " << t * 1e6 / n << " ns per element" << endl;
+
+    for (size_t i = 0; i != n; ++i) {
+        x.push_back(v);
+    }
+    b = chrono::steady_clock::now();
+    while (!x.empty()) {
+        out.clear();
+        x.drain_front_into(back_inserter(out), min(batch, x.size()));
+    }
+    t = elapsed(b);
+    cout << "batch " << name << " drain_front_into " << t << " ms, " << t * 1e6 / n << " ns per element" << endl;
+
+    for (size_t i = 0; i != n; ++i) {
+        x.push_back(v);
+    }
+    b = chrono::steady_clock::now();
+    while (!x.empty()) {
+        x.pop_back_n(min(batch, x.size()));
+    }
+    t = elapsed(b);
+    cout << "batch " << name << " pop_back_n       " << t << " ms, " << t * 1e6 / n << " ns per element" << endl;
+}
+
+/**
+ * @param n a size
+ * times dequeuing n ints and n strings in batches of 256
+ */
+void bench_batch (size_t n) {
+    batch_drain(n, 7, "int   ");
+    batch_drain(n / 4, string(40, 's'), "string");
+}
+
+// -----------
+// bench_purge
+// -----------
+
+/**
+ * @param n a size
+ * times removing every tenth element of n, erasing them one at a time on n / 50 elements and
+ * with a single erase_if on all n
+ */
+void bench_purge (size_t n) {
+    MyDeque<int> x;
+    for (size_t i = 0; i != n / 50; ++i) {
+        x.push_back(i);
+    }
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (MyDeque<int>::iterator p = x.begin(); p != x.end();) {
+        p = (*p % 10 == 0) ? x.erase(p) : p + 1;
+    }
+    cout << "purge erase    " << n / 50 << " elements " << elapsed(b) << " ms" << endl;
+
+    MyDeque<int> y;
+    for (size_t i = 0; i != n; ++i) {
+        y.push_back(i);
+    }
+    b = chrono::steady_clock::now();
+    size_t k = y.erase_if([] (int v) {return v % 10 == 0;});
+    cout << "purge erase_if " << n << " elements " << elapsed(b) << " ms" << endl;
+    if (k != (n + 9) / 10) {
+        cout << "purge MISMATCH" << endl;
+    }
+}
+
+// -------------
+// bench_compare
+// -------------
+
+/**
+ * @param n a size
+ * times == and < on two equal deques of n bytes laid out at different block offsets, through the
+ * iterators and through the operators
+ */
+void bench_compare (size_t n) {
+    MyDeque<unsigned char> x;
+    MyDeque<unsigned char> y;
+    for (size_t i = 0; i != n; ++i) {
+        x.push_back(static_cast<unsigned char>(i));
+    }
+    for (size_t i = n; i != 0; --i) {
+        y.push_front(static_cast<unsigned char>(i - 1));
+    }
+    const MyDeque<unsigned char>& c = x;
+    const MyDeque<unsigned char>& d = y;
+
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    bool e = equal(c.begin(), c.end(), d.begin());
+    bool l = lexicographical_compare(c.begin(), c.end(), d.begin(), d.end());
+    cout << "compare iterators " << n / 1024 << " KiB " << elapsed(b) << " ms" << endl;
+
+    b = chrono::steady_clock::now();
+    bool f = (x == y);
+    bool m = (x < y);
+    cout << "compare operators " << n / 1024 << " KiB " << elapsed(b) << " ms" << endl;
+    if (e != f || l != m) {
+        cout << "compare MISMATCH" << endl;
+    }
+}
+
+// -------------
+// bench_latency
+// -------------
+
+/**
+ * @param x a MyDeque<int>
+ * @param n a size
+ * @param name a string
+ * times each of n push_backs, with a pop_front after every third, and prints the percentiles
+ */
+void push_latency (MyDeque<int>& x, size_t n, const char* name) {
+    vector<double> t(n);
+    for (size_t i = 0; i != n; ++i) {
+        chrono::steady_clock::time_point b = chrono::steady_clock::now();
+        x.push_back(i);
+        if (i % 3 == 0) {
+            x.pop_front();
+        }
+        t[i] = chrono::duration<double, nano>(chrono::steady_clock::now() - b).count();
+    }
+    sort(t.begin(), t.end());
+    cout << "latency " << name << " p50 "   << t[n / 2]
+                                << " p99 "   << t[n / 100 * 99]
+                                << " p99.9 " << t[n / 1000 * 999]
+                                << " max "   << t[n - 1] << " ns" << endl;
+}
+
+/**
+ * @param n a size
+ * compares the per operation tail latency of growing the outer container all at once with
+ * growing it gradually
+ */
+void bench_latency (size_t n) {
+    MyDeque<int> x;
+    push_latency(x, n, "at once  ");
+    MyDeque<int> y;
+    y.gradual_growth(true);
+    push_latency(y, n, "gradually");
+}
+
+// ------------
+// bench_assign
+// ------------
+
+/**
+ * @param n a size
+ * times reassigning a 1000 element buffer n / 1000 times, as a copy swapped in and with =, which
+ * reuses the blocks the buffer already has, and with = from sizes that change every tick
+ */
+void bench_assign (size_t n) {
+    const size_t m = 1000;
+    MyDeque<int> x;
+    MyDeque<int> y;
+    MyDeque<int> z;
+    for (size_t i = 0; i != m; ++i) {
+        x.push_back(i);
+        y.push_back(0);
+        z.push_back(i);
+        z.push_back(i);
+    }
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t i = 0; i != n / m; ++i) {
+        MyDeque<int> t(x);
+        y.swap(t);
+    }
+    cout << "assign copy    " << n / m << " times " << elapsed(b) << " ms" << endl;
+
+    b = chrono::steady_clock::now();
+    for (size_t i = 0; i != n / m; ++i) {
+        y = x;
+    }
+    cout << "assign =       " << n / m << " times " << elapsed(b) << " ms" << endl;
+
+    b = chrono::steady_clock::now();
+    for (size_t i = 0; i != n / m; ++i) {
+        y = (i % 2) ? x : z;
+    }
+    cout << "assign resized " << n / m << " times " << elapsed(b) << " ms" << endl;
+    if (y.size() != ((n / m) % 2 ? 2 * m : m) || y.front() != 0) {
+        cout << "assign MISMATCH" << endl;
+    }
+}
+
+// ----------
+// bench_span
+// ----------
+
+/**
+ * @param n a size
+ * times moving n bytes from one pipe to another through a MyDeque<char> in 64 KiB chunks, by way
+ * of a buffer and push_back, and straight into and out of its blocks with readv and writev
+ */
+void bench_span (size_t n) {
+#ifdef __linux__
+    const size_t  chunk = 1 << 16;
+    vector<char>  src(chunk, 'x');
+    vector<char>  buf(chunk);
+    int           in[2];
+    int           out[2];
+    if (pipe(in) || pipe(out)) {
+        cout << "span n/a" << endl;
+        return;
+    }
+
+    MyDeque<char> x;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t d = 0; d < n; d += chunk) {
+        ssize_t r = write(in[1], &src[0], chunk);
+        r = read(in[0], &buf[0], r);
+        for (ssize_t i = 0; i != r; ++i) {
+            x.push_back(buf[i]);
+        }
+        size_t m = 0;
+        while (!x.empty()) {
+            buf[m++] = x.front();
+            x.pop_front();
+        }
+        r = write(out[1], &buf[0], m);
+        r = read(out[0], &buf[0], r);
+    }
+    cout << "span push_back and copy    " << elapsed(b) << " ms" << endl;
+
+    MyDeque<char>::segment       v[IOV_MAX];
+    MyDeque<char>::const_segment w[IOV_MAX];
+    b = chrono::steady_clock::now();
+    for (size_t d = 0; d < n; d += chunk) {
+        ssize_t p = write(in[1], &src[0], chunk);
+        ssize_t r = 0;
+        size_t  c = 0;
+        for (; p > 0; p -= r) {
+            c = x.acquire_back(p, v, IOV_MAX);
+            r = readv(in[0], reinterpret_cast<iovec*>(v), c);
+            x.commit_back(r);
+        }
+        while (!x.empty()) {
+            c = x.peek_front(w, IOV_MAX);
+            r = writev(out[1], reinterpret_cast<const iovec*>(w), c);
+            x.consume_front(r);
+            r = read(out[0], &buf[0], r);
+        }
+    }
+    cout << "span acquire_back and peek " << elapsed(b) << " ms" << endl;
+
+    close(in[0]);
+    close(in[1]);
+    close(out[0]);
+    close(out[1]);
+#else
+    (void) n;
+    cout << "span n/a" << endl;
+#endif
+}
+
+// ------------
+// bench_frames
+// ------------
+
+/**
+ * @param n a size
+ * times splitting n newline terminated lines arriving in 64 KiB chunks, by pushing the bytes into
+ * a MyDeque<char> and popping them one at a time, and with MyByteBuffer's find and peek_contiguous
+ */
+void bench_frames (size_t n) {
+    const size_t chunk = 1 << 16;
+    string       src;
+    for (size_t i = 0; i != n; ++i) {
+        src += string(20 + i % 120, 'a' + i % 26) + "\n";
+    }
+
+    MyDeque<char> x;
+    string        line;
+    size_t        lines = 0;
+    size_t        bytes = 0;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t d = 0; d < src.size(); d += chunk) {
+        size_t m = min(chunk, src.size() - d);
+        for (size_t i = 0; i != m; ++i) {
+            x.push_back(src[d + i]);
+        }
+        MyDeque<char>::iterator p = find(x.begin(), x.end(), '\n');
+        while (p != x.end()) {
+            line.clear();
+            while (x.front() != '\n') {
+                line += x.front();
+                x.pop_front();
+            }
+            x.pop_front();
+            ++lines;
+            bytes += line.size();
+            p = find(x.begin(), x.end(), '\n');
+        }
+    }
+    cout << "frames MyDeque<char>  " << elapsed(b) << " ms, " << lines << " lines, " << bytes << " bytes" << endl;
+
+    MyByteBuffer<> y;
+    lines = 0;
+    bytes = 0;
+    b = chrono::steady_clock::now();
+    for (size_t d = 0; d < src.size(); d += chunk) {
+        y.append(src.data() + d, min(chunk, src.size() - d));
+        for (size_t k; (k = y.find('\n')) != MyByteBuffer<>::npos; y.consume(k + 1)) {
+            const char* p = y.peek_contiguous(k);
+            ++lines;
+            bytes += (p != 0) ? k : 0;
+        }
+    }
+    cout << "frames MyByteBuffer   " << elapsed(b) << " ms, " << lines << " lines, " << bytes << " bytes" << endl;
+}
+
+// ------------
+// bench_packed
+// ------------
+
+/**
+ * @param n a size
+ * compares a MyDeque and a MyPackedDeque of n sequence numbers and of n jittery nanosecond
+ * timestamps: bytes held, time to push them all, and time for a pass over them
+ */
+void bench_packed (size_t n) {
+    for (int kind = 0; kind != 2; ++kind) {
+        const char*  name = kind ? "timestamps" : "sequence  ";
+        vector<long> v(n);
+        long         t = 1700000000000000000L;
+        for (size_t i = 0; i != n; ++i) {
+            t += kind ? 1000 + rand() % 4000 : 1;
+            v[i] = t;
+        }
+
+        MyDeque<long> x;
+        chrono::steady_clock::time_point b = chrono::steady_clock::now();
+        for (size_t i = 0; i != n; ++i) {
+            x.push_back(v[i]);
+        }
+        double push = elapsed(b);
+        const MyDeque<long>& c = x;
+        long sum = 0;
+        b = chrono::steady_clock::now();
+        for (MyDeque<long>::const_iterator p = c.begin(); p != c.end(); ++p) {
+            sum += *p;
+        }
+        cout << "packed " << name << " MyDeque       " << n * sizeof(long) / 1024 << " KiB, push " << push << " ms, scan " << elapsed(b) << " ms" << endl;
+
+        MyPackedDeque<long> y;
+        b = chrono::steady_clock::now();
+        for (size_t i = 0; i != n; ++i) {
+            y.push_back(v[i]);
+        }
+        push = elapsed(b);
+        long check = 0;
+        b = chrono::steady_clock::now();
+        for (MyPackedDeque<long>::const_iterator p = y.begin(); p != y.end(); ++p) {
+            check += *p;
+        }
+        cout << "packed " << name << " MyPackedDeque " << y.footprint() / 1024 << " KiB, push " << push << " ms, scan " << elapsed(b) << " ms" << endl;
+        if (sum != check) {
+            cout << "packed " << name << " MISMATCH" << endl;
+        }
+    }
+}
+
+// ----------
+// bench_bits
+// ----------
+
+/**
+ * @param n a size
+ * compares n flags kept a byte each, in a MyDeque<char>, with the bit-packed MyDeque<bool>:
+ * bytes held, and time to count the set flags in every window of 4096 flags, 4096 apart
+ */
+void bench_bits (size_t n) {
+    const size_t  window = 4096;
+    MyDeque<char> x;
+    MyDeque<bool> y;
+    for (size_t i = 0; i != n; ++i) {
+        bool v = rand() % 7 == 0;
+        x.push_back(v);
+        y.push_back(v);
+    }
+
+    const MyDeque<char>& c = x;
+    size_t sum = 0;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t f = 0; f + window <= n; f += window) {
+        sum += count(c.begin() + f, c.begin() + f + window, 1);
+    }
+    cout << "bits MyDeque<char> " << n / 1024 << " KiB, windows " << elapsed(b) << " ms" << endl;
+
+    size_t check = 0;
+    b = chrono::steady_clock::now();
+    for (size_t f = 0; f + window <= n; f += window) {
+        check += y.popcount(f, f + window);
+    }
+    cout << "bits MyDeque<bool> " << (n + 63) / 64 * 8 / 1024 << " KiB, windows " << elapsed(b) << " ms" << endl;
+    if (sum != check) {
+        cout << "bits MISMATCH" << endl;
+    }
+}
+
+// ------------
+// bench_sorted
+// ------------
+
+/**
+ * range lookups over n increasing timestamps: std::lower_bound through MyDeque's iterators
+ * against MySortedDeque's fences, with std::lower_bound over a flat array as the floor
+ */
+void bench_sorted (size_t n) {
+    const size_t             q = 1000000;
+    MyDeque<long long>       x;
+    MySortedDeque<long long> y;
+    vector<long long>        z;
+    long long                t = 0;
+    for (size_t i = 0; i != n; ++i) {
+        t += 1 + rand() % 16;
+        x.push_back(t);
+        y.push_back(t);
+        z.push_back(t);
+    }
+    vector<long long> k(q);
+    for (size_t i = 0; i != q; ++i) {
+        k[i] = (static_cast<long long>(rand()) * RAND_MAX + rand()) % t;
+    }
+
+    const MyDeque<long long>& c = x;
+    size_t sum = 0;
+    chrono::steady_clock::time_point b = chrono::steady_clock::now();
+    for (size_t i = 0; i != q; ++i) {
+        sum += lower_bound(c.begin(), c.end(), k[i]) - c.begin();
+    }
+    double ms = elapsed(b);
+    cout << "sorted std::lower_bound " << n << " keys, " << ms * 1000000 / q << " ns per lookup" << endl;
+
+    size_t check = 0;
+    b = chrono::steady_clock::now();
+    for (size_t i = 0; i != q; ++i) {
+        check += y.lower_index(k[i]);
+    }
+    ms = elapsed(b);
+    cout << "sorted fence            " << n << " keys, " << ms * 1000000 / q << " ns per lookup" << endl;
+
+    size_t flat = 0;
+    b = chrono::steady_clock::now();
+    for (size_t i = 0; i != q; ++i) {
+        flat += lower_bound(z.begin(), z.end(), k[i]) - z.begin();
+    }
+    ms = elapsed(b);
+    cout << "sorted vector           " << n << " keys, " << ms * 1000000 / q << " ns per lookup" << endl;
+    if (sum != check || flat != check) {
+        cout << "sorted MISMATCH" << endl;
+    }
+}
+
+// ----
+// main
+// ----
+
+int main (int argc, char* argv[]) {
+    const char* section = (argc > 1) ? argv[1] : "all";
+    size_t      n       = (argc > 2) ? atol(argv[2]) : 0;
+
+    if (!strcmp(section, "all") || !strcmp(section, "sort")) {
+        bench_sort(n ? n : 5000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "window")) {
+        bench_window(n ? n : 1000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "snapshot")) {
+        bench_snapshot(n ? n : 1000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "index")) {
+        bench_index(n ? n : 5000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "tiered")) {
+        bench_tiered(n ? n : 1000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "soa")) {
+        bench_soa(n ? n : 4000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "aligned")) {
+        bench_aligned(n ? n : 50000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "hugepage")) {
+        bench_hugepage(n ? n : (1 << 30) / sizeof(int));
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "batch")) {
+        bench_batch(n ? n : 20000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "purge")) {
+        bench_purge(n ? n : 5000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "compare")) {
+        bench_compare(n ? n : 100000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "latency")) {
+        bench_latency(n ? n : 30000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "assign")) {
+        bench_assign(n ? n : 100000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "span")) {
+        bench_span(n ? n : 256 << 20);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "frames")) {
+        bench_frames(n ? n : 1000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "packed")) {
+        bench_packed(n ? n : 10000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "bits")) {
+        bench_bits(n ? n : 100000000);
+    }
+    if (!strcmp(section, "all") || !strcmp(section, "sorted")) {
+        bench_sorted(n ? n : 10000000);
+    }
+    return 0;
+}
@@ -0,0 +1,405 @@
+// ----------------------------
+// projects/deque/ByteBuffer.h
+// ----------------------------
+
+#ifndef ByteBuffer_h
+#define ByteBuffer_h
+#define BUFFER_PAGE 4096
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // min
+#include <cassert>   // assert
+#include <cstddef>   // size_t
+#include <cstring>   // memchr, memcpy
+#include <vector>    // vector
+
+#ifdef __unix__
+#include <climits>   // IOV_MAX
+#include <sys/uio.h> // iovec, readv, writev
+#endif
+
+#include "AlignedAllocator.h"
+#include "Deque.h"
+
+// ------------
+// MyByteBuffer
+// ------------
+
+/**
+ * a queue of bytes for protocol parsing, kept in page sized, page aligned blocks
+ *
+ * The pages sit in a MyDeque<char*>, bytes arrive at the back of the last page and leave from the
+ * front of the first, and emptied pages are kept for reuse. read_from and write_to move bytes
+ * between a file descriptor and the pages with one readv or writev. find searches page by page
+ * with memchr, and peek_contiguous only copies a frame when it runs over the end of a page.
+ * The pages come from A, page aligned by default.
+ */
+template < typename A = aligned_allocator<char, BUFFER_PAGE> >
+class MyByteBuffer {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                   allocator_type;
+        typedef typename allocator_type::size_type  size_type;
+
+        static const size_type npos = static_cast<size_type>(-1);
+
+    private:
+        // ----
+        // data
+        // ----
+
+        allocator_type     _a;
+
+        MyDeque<char*>     _m;      // pages holding bytes, in order
+        std::vector<char*> _spare;  // emptied pages, kept for the next ones needed
+        std::vector<char>  _flat;   // frames peek_contiguous had to copy together
+        size_type          _b;      // first byte in the first page
+        size_type          _e;      // one past the last byte in the last page
+        size_type          _s;      // number of bytes
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            if (_m.empty()) {
+                return !_s && !_b && !_e;
+            }
+            return (_b < BUFFER_PAGE) && (0 < _e) && (_e <= BUFFER_PAGE) &&
+                   (_s == _m.size() * BUFFER_PAGE - _b - (BUFFER_PAGE - _e));
+        }
+
+        // ---------
+        // take_page
+        // ---------
+
+        /**
+         * @return a page, reused if one was given up
+         */
+        char* take_page () {
+            if (_spare.empty()) {
+                return _a.allocate(BUFFER_PAGE);
+            }
+            char* p = _spare.back();
+            _spare.pop_back();
+            return p;
+        }
+
+        // ---------
+        // give_page
+        // ---------
+
+        void give_page (char* p) {
+            _spare.push_back(p);
+        }
+
+        // ----
+        // room
+        // ----
+
+        /**
+         * @return the bytes free at the end of the last page
+         */
+        size_type room () const {
+            return _m.empty() ? 0 : BUFFER_PAGE - _e;
+        }
+
+        // ------
+        // commit
+        // ------
+
+        /**
+         * @param n a size_type
+         * @param q the pages taken for a read, in order
+         * counts n more bytes as held, filling what is free at the end of the last page and then
+         * the pages of q, and gives back the pages of q that got nothing, or that it could not keep
+         * if adding one throws
+         */
+        void commit (size_type n, const std::vector<char*>& q) {
+            size_type k = std::min(n, room());
+            _e += k;
+            _s += k;
+            n  -= k;
+            for (size_type i = 0; i != q.size(); ++i) {
+                if (!n) {
+                    give_page(q[i]);
+                    continue;
+                }
+                try {
+                    _m.push_back(q[i]);
+                }
+                catch (...) {
+                    for (size_type j = i; j != q.size(); ++j) {
+                        give_page(q[j]);
+                    }
+                    throw;
+                }
+                _e = std::min<size_type>(n, BUFFER_PAGE);
+                _s += _e;
+                n  -= _e;
+            }
+            assert(valid());
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        explicit MyByteBuffer (const allocator_type& a = allocator_type()) :
+                _a (a), _b (0), _e (0), _s (0)
+            {}
+
+        MyByteBuffer (const MyByteBuffer&) = delete;
+        MyByteBuffer& operator = (const MyByteBuffer&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~MyByteBuffer () {
+            clear();
+            for (size_type i = 0; i != _spare.size(); ++i) {
+                _a.deallocate(_spare[i], BUFFER_PAGE);
+            }
+        }
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param index a size_type, less than size()
+         * @return the byte at index
+         */
+        char operator [] (size_type index) const {
+            assert(index < size());
+            size_type g = _b + index;
+            return _m[g / BUFFER_PAGE][g % BUFFER_PAGE];
+        }
+
+        // ------
+        // append
+        // ------
+
+        /**
+         * @param p a pointer to n bytes
+         * @param n a size_type
+         * adds the n bytes at p after the last byte
+         */
+        void append (const char* p, size_type n) {
+            while (n) {
+                if (!room()) {
+                    _m.push_back(take_page());
+                    _e = 0;
+                }
+                size_type k = std::min(n, room());
+                std::memcpy(_m.back() + _e, p, k);
+                _e += k;
+                _s += k;
+                p  += k;
+                n  -= k;
+            }
+            assert(valid());
+        }
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * removes every byte, keeping the pages for reuse
+         */
+        void clear () {
+            consume(size());
+        }
+
+        // -------
+        // consume
+        // -------
+
+        /**
+         * @param n a size_type, at most size()
+         * removes the first n bytes, giving up the pages they empty
+         */
+        void consume (size_type n) {
+            assert(n <= size());
+            _s -= n;
+            n  += _b;
+            while (!_m.empty() && (n >= BUFFER_PAGE || !_s)) {
+                give_page(_m.front());
+                _m.pop_front();
+                n -= std::min<size_type>(n, BUFFER_PAGE);
+            }
+            _b = _m.empty() ? 0 : n;
+            if (_m.empty()) {
+                _e = 0;
+            }
+            assert(valid());
+        }
+
+        // --------
+        // copy_out
+        // --------
+
+        /**
+         * @param x a pointer to room for n bytes
+         * @param n a size_type
+         * @param from a size_type, with from + n at most size()
+         * copies the n bytes starting at index from to x
+         */
+        void copy_out (char* x, size_type n, size_type from = 0) const {
+            assert(from + n <= size());
+            size_type g = _b + from;
+            while (n) {
+                size_type k = std::min<size_type>(n, BUFFER_PAGE - g % BUFFER_PAGE);
+                std::memcpy(x, _m[g / BUFFER_PAGE] + g % BUFFER_PAGE, k);
+                x += k;
+                g += k;
+                n -= k;
+            }
+        }
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return !_s;
+        }
+
+        // ----
+        // find
+        // ----
+
+        /**
+         * @param c a char
+         * @param from a size_type
+         * @return the index of the first c at or after index from, or npos
+         * searches each page's bytes with memchr, which the C library vectorizes
+         */
+        size_type find (char c, size_type from = 0) const {
+            if (from >= size()) {
+                return npos;
+            }
+            size_type g = _b + from;
+            size_type l = _b + size();
+            while (g != l) {
+                size_type   k = std::min<size_type>(l - g, BUFFER_PAGE - g % BUFFER_PAGE);
+                const char* p = _m[g / BUFFER_PAGE] + g % BUFFER_PAGE;
+                const void* q = std::memchr(p, c, k);
+                if (q) {
+                    return g - _b + (static_cast<const char*>(q) - p);
+                }
+                g += k;
+            }
+            return npos;
+        }
+
+        // ---------------
+        // peek_contiguous
+        // ---------------
+
+        /**
+         * @param n a size_type, at most size()
+         * @return a pointer to the first n bytes, one after another
+         * points into the first page when they all sit there, and otherwise at a copy of them,
+         * which lasts until the next call
+         */
+        const char* peek_contiguous (size_type n) {
+            assert(n <= size());
+            if (_m.empty() || _b + n <= BUFFER_PAGE) {
+                return _m.empty() ? 0 : _m.front() + _b;
+            }
+            _flat.resize(n);
+            copy_out(&_flat[0], n);
+            return &_flat[0];
+        }
+
+#ifdef __unix__
+        // ---------
+        // read_from
+        // ---------
+
+        /**
+         * @param fd a file descriptor
+         * @param n a size_type, the most bytes to read
+         * @return what readv returned: the bytes read, 0 at end of file, or -1 with errno set
+         * reads up to n bytes from fd straight into the free end of the last page and fresh pages
+         * room for every page is reserved first, so a page taken is never lost if one throws
+         */
+        ssize_t read_from (int fd, size_type n = 16 * BUFFER_PAGE) {
+            size_type c = (n > room()) ? (n - room() + BUFFER_PAGE - 1) / BUFFER_PAGE : 0;
+            c = std::min<size_type>(c, IOV_MAX - (room() ? 1 : 0));
+            std::vector<char*> q;
+            std::vector<iovec> v;
+            q.reserve(c);
+            v.reserve(c + 1);
+            _spare.reserve(_spare.size() + c);
+            if (room()) {
+                iovec x = {_m.back() + _e, std::min(n, room())};
+                v.push_back(x);
+            }
+            try {
+                for (size_type t = room(); t < n && v.size() != IOV_MAX; t += BUFFER_PAGE) {
+                    q.push_back(take_page());
+                    iovec x = {q.back(), std::min<size_type>(n - t, BUFFER_PAGE)};
+                    v.push_back(x);
+                }
+            }
+            catch (...) {
+                for (size_type i = 0; i != q.size(); ++i) {
+                    give_page(q[i]);
+                }
+                throw;
+            }
+            ssize_t r = v.empty() ? 0 : readv(fd, &v[0], v.size());
+            commit(r > 0 ? r : 0, q);
+            return r;
+        }
+
+        // --------
+        // write_to
+        // --------
+
+        /**
+         * @param fd a file descriptor
+         * @return what writev returned: the bytes written or -1 with errno set
+         * writes the bytes straight from the pages to fd and removes the ones written
+         */
+        ssize_t write_to (int fd) {
+            std::vector<iovec> v;
+            for (size_type k = 0; k != _m.size() && v.size() != IOV_MAX; ++k) {
+                size_type b = (k == 0)              ? _b : 0;
+                size_type e = (k == _m.size() - 1) ? _e : BUFFER_PAGE;
+                iovec     x = {_m[k] + b, e - b};
+                v.push_back(x);
+            }
+            ssize_t r = v.empty() ? 0 : writev(fd, &v[0], v.size());
+            if (r > 0) {
+                consume(r);
+            }
+            return r;
+        }
+#endif
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _s;
+        }
+};
+
+template <typename A>
+const typename MyByteBuffer<A>::size_type MyByteBuffer<A>::npos;
+
+#endif // ByteBuffer_h
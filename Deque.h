@@ -7,17 +7,23 @@
 #ifndef Deque_h
 #define Deque_h
 #define BLOCK_WIDTH 20
+#define GROWTH_STEP 2
 
 // --------
 // includes
 // --------
 
-#include <algorithm> // copy, equal, lexicographical_compare, max, swap
-#include <cassert>   // assert
-#include <iterator>  // iterator, bidirectional_iterator_tag
-#include <memory>    // allocator
-#include <stdexcept> // out_of_range
-#include <utility>   // !=, <=, >, >=
+#include <algorithm>  // copy, equal, find_if, lexicographical_compare, max, min, mismatch, move, sort, stable_sort, swap
+#include <cassert>    // assert
+#include <cstring>    // memcmp, memcpy, memmove
+#include <functional> // less
+#include <iterator>   // distance, iterator, random_access_iterator_tag
+#include <memory>     // allocator, allocator_traits
+#include <stdexcept>  // length_error, out_of_range
+#include <thread>     // thread
+#include <type_traits> // enable_if, integral_constant, is_integral, is_trivially_copyable, is_trivially_destructible
+#include <utility>    // !=, <=, >, >=, move
+#include <vector>     // vector
 
 // -----
 // using
@@ -38,7 +44,7 @@ BI destroy (A& a, BI b, BI e) {
     while (b != e) {
         ++i;
         --e;
-        a.destroy(&*e);
+        std::allocator_traits<A>::destroy(a, &*e);
     }
     return b;
 }
@@ -52,7 +58,7 @@ BI uninitialized_copy (A& a, II b, II e, BI x) {
     BI p = x;
     try {
         while (b != e) {
-            a.construct(&*x, *b);
+            std::allocator_traits<A>::construct(a, &*x, *b);
             ++b;
             ++x;
         }
@@ -73,7 +79,7 @@ BI uninitialized_fill (A& a, BI b, BI e, const U& v) {
     BI p = b;
     try {
         while (b != e) {
-            a.construct(&*b, v);
+            std::allocator_traits<A>::construct(a, &*b, v);
             ++b;
         }
     }
@@ -84,6 +90,50 @@ BI uninitialized_fill (A& a, BI b, BI e, const U& v) {
     return e;
 }
 
+// ------------------------
+// is_trivially_relocatable
+// ------------------------
+
+/**
+ * whether moving a T to new memory and destroying the original is the same as copying its bytes
+ * true for trivially copyable types; specialize it for types that hold no pointers into themselves,
+ * like the smart pointers below (but not a std::string with its inline buffer)
+ */
+template <typename T>
+struct is_trivially_relocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
+template <typename T, typename D>
+struct is_trivially_relocatable< std::unique_ptr<T, D> > : is_trivially_relocatable<D> {};
+
+template <typename T>
+struct is_trivially_relocatable< std::shared_ptr<T> > : std::true_type {};
+
+// ---------------------
+// is_bitwise_comparable
+// ---------------------
+
+/**
+ * whether two Ts are equal exactly when their bytes are, so runs of them can be compared with memcmp
+ * true for integers, enums and pointers; not for floating point (0.0 == -0.0, NaN != NaN) or for
+ * types with padding, so specialize it only for padding-free types compared member by member
+ */
+template <typename T>
+struct is_bitwise_comparable : std::integral_constant<bool, std::is_integral<T>::value ||
+                                                            std::is_enum<T>::value     ||
+                                                            std::is_pointer<T>::value> {};
+
+// ---------------
+// overflow_policy
+// ---------------
+
+/**
+ * what a bounded MyDeque does with a push once it holds its capacity
+ */
+enum overflow_policy {
+    overwrite_oldest,   // drop the element at the other end to make room
+    reject_newest       // leave the MyDeque alone and report the push as failed
+};
+
 // -------
 // MyDeque
 // -------
@@ -101,14 +151,36 @@ class MyDeque {
         typedef typename allocator_type::size_type                  size_type;
         typedef typename allocator_type::difference_type            difference_type;
 
-        typedef typename allocator_type::pointer                    pointer;
-        typedef typename allocator_type::const_pointer              const_pointer;
+        typedef std::allocator_traits<allocator_type>               traits_type;
 
-        typedef typename allocator_type::reference                  reference;
-        typedef typename allocator_type::const_reference            const_reference;
+        typedef typename traits_type::pointer                       pointer;
+        typedef typename traits_type::const_pointer                 const_pointer;
+
+        typedef value_type&                                         reference;
+        typedef const value_type&                                   const_reference;
         
-        typedef typename allocator_type::template rebind<T*>::other p_allocator_type;
-        typedef typename p_allocator_type::pointer                  p_pointer;
+        typedef typename traits_type::template rebind_alloc<T*>         p_allocator_type;
+        typedef typename traits_type::template rebind_alloc<size_type*> r_allocator_type;
+        typedef typename traits_type::template rebind_alloc<size_type>  c_allocator_type;
+        typedef typename std::allocator_traits<p_allocator_type>::pointer p_pointer;
+
+        /**
+         * a run of length elements starting at base, all in one block
+         * for a MyDeque<char> it is laid out like a struct iovec, so an array of them can go to readv
+         */
+        struct segment {
+            pointer   base;
+            size_type length;
+        };
+
+        /**
+         * a run of length elements starting at base, all in one block
+         * for a MyDeque<char> it is laid out like a struct iovec, so an array of them can go to writev
+         */
+        struct const_segment {
+            const_pointer base;
+            size_type     length;
+        };
         
     public:
         // -----------
@@ -122,7 +194,10 @@ class MyDeque {
          * checks if two MyDeque objects are equal to each other
          */
         friend bool operator == (const MyDeque& lhs, const MyDeque& rhs) {
-            return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+            return (lhs.size() == rhs.size()) &&
+                   zip_segments(lhs, rhs, lhs.size(), [] (const_pointer p, const_pointer q, size_type n) {
+                       return equal_run(p, q, n, is_bitwise_comparable<T>());
+                   });
         }
 
         // ----------
@@ -136,7 +211,12 @@ class MyDeque {
          * checks if a MyDeque object is less than the other
          */
         friend bool operator < (const MyDeque& lhs, const MyDeque& rhs) {
-            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+            int r = 0;
+            zip_segments(lhs, rhs, std::min(lhs.size(), rhs.size()), [&r] (const_pointer p, const_pointer q, size_type n) {
+                r = compare_run(p, q, n, is_bitwise_comparable<T>());
+                return !r;
+            });
+            return r ? (r < 0) : (lhs.size() < rhs.size());
         }
 
     private:
@@ -155,710 +235,3737 @@ class MyDeque {
         
         pointer _b;             // beginning of filled area in inner container
         pointer _e;
+
+        size_type _s;           // number of elements, kept by every mutator
         
         size_type block_size;
 
+        static const size_type prefetch_ahead = 1 + 256 / (BLOCK_WIDTH * sizeof(T));
+
+        size_type       _limit;     // most elements a bounded MyDeque holds, 0 if unbounded
+        overflow_policy _policy;
+
+        mutable size_type** _r;     // reference count of each block shared with a copy, 0 if never shared
+        bool                _cow;   // copies share blocks instead of copying elements
+
+        /**
+         * an outer container being filled in a few slots at a time, for gradual growth
+         */
+        struct growth {
+            p_pointer       map;    // 0 if no growth is under way
+            size_type       size;
+            size_type       done;   // slots of map filled in so far
+            difference_type shift;  // block k of _top lands at slot k + shift of map
+            size_type       spare;  // next block of _top that falls outside map, handed to a new slot
+            size_type       last;   // one past the last such block
+
+            growth () :
+                    map (0), size (0), done (0), shift (0), spare (0), last (0)
+                {}
+        };
+
+        growth              _g;
+        bool                _gradual;   // grow the outer container a few slots per push and pop
+
     private:
         // -----
         // valid
         // -----
 
         bool valid () const {
-            return (!_top && !_bottom && !_b && !_e) || ((_top <= _bottom) && (_b <= _e));
+            return ((!_top && !_bottom && !_b && !_e) || ((_top <= _bottom) && (_u_top <= _u_bottom))) && (_s == count()) &&
+                   (!_g.map || _g.done < _g.size);
         }
 
-    public:
-        // --------
-        // iterator
-        // --------
+        // -----
+        // count
+        // -----
 
-        class iterator {
-            public:
-                // --------
-                // typedefs
-                // --------
+        /**
+         * @return a size_type
+         * works the number of elements out from the layout, for checking _s
+         */
+        size_type count () const {
+            if (!_top) {
+                return 0;
+            }
+            return (_u_bottom - _u_top) * BLOCK_WIDTH + (_e - _top[_u_bottom]) - (_b - _top[_u_top]);
+        }
 
-                typedef std::bidirectional_iterator_tag   iterator_category;
-                typedef typename MyDeque::value_type      value_type;
-                typedef typename MyDeque::difference_type difference_type;
-                typedef typename MyDeque::pointer         pointer;
-                typedef typename MyDeque::reference       reference;
+        // -------
+        // set_end
+        // -------
 
-            public:
-                // -----------
-                // operator ==
-                // -----------
+        /**
+         * @param s a size_type
+         * points _u_bottom and _e just past the s-th element from _b
+         * _e never rests on the end of a block, so the block after the last element must exist
+         */
+        void set_end (size_type s) {
+            size_type n = (_b - _top[_u_top]) + s;
+            _u_bottom = _u_top + n / BLOCK_WIDTH;
+            _e = _top[_u_bottom] + n % BLOCK_WIDTH;
+            _s = s;
+        }
 
-                /**
-                 * @param lhs an iterator reference
-                 * @param rhs an iterator reference
-                 * @return a bool
-                 * checks to see if two iterators are equal to each other
-                 */
-                friend bool operator == (const iterator& lhs, const iterator& rhs) {
-                    return lhs.i == rhs.i && lhs.j == rhs.j;
-                }
+        // ------
+        // shared
+        // ------
 
-                /**
-                 * @param lhs an iterator reference
-                 * @param rhs an iterator reference
-                 * @return a bool
-                 * checks to see if two iterators are not equal to each other
-                 */
-                friend bool operator != (const iterator& lhs, const iterator& rhs) {
-                    return !(lhs == rhs);
-                }
+        /**
+         * @param k a size_type
+         * @return a bool
+         * checks if block k is also owned by another MyDeque
+         */
+        bool shared (size_type k) const {
+            return _r && _r[k] && *_r[k] > 1;
+        }
 
-                // ----------
-                // operator +
-                // ----------
+        // ---
+        // own
+        // ---
 
-                /**
-                 * @param lhs an iterator
-                 * @param rhs a difference_type
-                 * @return an iterator
-                 * increments an iterator by rhs
-                 */
-                friend iterator operator + (iterator lhs, difference_type rhs) {
-                    return lhs += rhs;
+        /**
+         * @param k a size_type
+         * @return a pointer to block k, which only this MyDeque owns
+         * clones block k first if another MyDeque shares it
+         */
+        pointer own (size_type k) {
+            if (_r && _r[k]) {
+                if (*_r[k] > 1) {
+                    pointer old = _top[k];
+                    pointer b = old;
+                    pointer e = old;
+                    if (_u_top <= k && k <= _u_bottom) {
+                        b = (k == _u_top)    ? _b : old;
+                        e = (k == _u_bottom) ? _e : old + BLOCK_WIDTH;
+                    }
+                    pointer x = _a.allocate(BLOCK_WIDTH);
+                    try {
+                        uninitialized_copy(_a, b, e, x + (b - old));
+                    }
+                    catch (...) {
+                        _a.deallocate(x, BLOCK_WIDTH);
+                        throw;
+                    }
+                    --*_r[k];
+                    _top[k] = x;
+                    if (k == _u_top) {
+                        _b = x + (_b - old);
+                    }
+                    if (k == _u_bottom) {
+                        _e = x + (_e - old);
+                    }
                 }
-
-                // ----------
-                // operator -
-                // ----------
-
-                /**
-                 * @param lhs an iterator
-                 * @param rhs a difference_type
-                 * @return an iterator
-                 * decrements an iterator by rhs
-                 */
-                friend iterator operator - (iterator lhs, difference_type rhs) {
-                    return lhs -= rhs;
+                else {
+                    c_allocator_type(_a).deallocate(_r[k], 1);
                 }
+                _r[k] = 0;
+            }
+            return _top[k];
+        }
 
-            private:
-                // ----
-                // data
-                // ----
+        // ------
+        // detach
+        // ------
 
-                MyDeque*  p;
-                size_type i;
-                size_type j;
+        /**
+         * makes every block owned by this MyDeque alone
+         */
+        void detach () {
+            settle();
+            if (!_r) {
+                return;
+            }
+            for (size_type k = 0; k != block_size; ++k) {
+                own(k);
+            }
+            r_allocator_type(_a).deallocate(_r, block_size);
+            _r = 0;
+        }
 
-            private:
-                // -----
-                // valid
-                // -----
+        // -----
+        // share
+        // -----
 
-                bool valid () const {
-                    return i >= 0 && j >= 0;
+        /**
+         * @param that a MyDeque reference
+         * makes this MyDeque, which owns nothing yet, share the blocks of that
+         * only the outer container is copied, the blocks are cloned by whichever side writes first
+         * a gradual growth of that is finished first, since it would not carry the counts along
+         */
+        void share (const MyDeque& that) {
+            const_cast<MyDeque&>(that).settle();
+            size_type used = that._u_bottom - that._u_top + 1;
+            size_type base = _limit ? that._u_top : 0;
+            block_size = _limit ? that.block_size : used;
+
+            if (!that._r) {
+                that._r = r_allocator_type(_a).allocate(that.block_size);
+                std::fill(that._r, that._r + that.block_size, static_cast<size_type*>(0));
+            }
+            _top = _p.allocate(block_size);
+            _bottom = _top + block_size;
+            _r = r_allocator_type(_a).allocate(block_size);
+            for (size_type k = 0; k != block_size; ++k) {
+                if (k < base || k >= base + used) {
+                    _top[k] = _a.allocate(BLOCK_WIDTH);
+                    _r[k] = 0;
+                    continue;
                 }
-
-            public:
-                // -----------
-                // constructor
-                // -----------
-
-                /**
-                 * @param x a MyDeque pointer
-                 * @param y a size_type
-                 * @param z a size_type
-                 * @return a new iterator
-                 * constructs a new iterator pointing to an element's address
-                 */
-                iterator (MyDeque* x, size_type y, size_type z) : p(x) {
-                    i = y;
-                    j = z;
-                    assert(valid());
+                size_type s = k - base + that._u_top;
+                if (!that._r[s]) {
+                    that._r[s] = c_allocator_type(_a).allocate(1);
+                    *that._r[s] = 1;
                 }
+                ++*that._r[s];
+                _r[k] = that._r[s];
+                _top[k] = that._top[s];
+            }
 
-                // Default copy, destructor, and copy assignment.
-                // iterator (const iterator&);
-                // ~iterator ();
-                // iterator& operator = (const iterator&);
-
-                // ----------
-                // operator *
-                // ----------
+            _u_top = base;
+            _u_bottom = base + used - 1;
+            _b = _top[_u_top] + (that._b - that._top[that._u_top]);
+            _e = _top[_u_bottom] + (that._e - that._top[that._u_bottom]);
+            _s = that._s;
+        }
 
-                /**
-                 * @return a reference to the element being pointed to
-                 * dereferences an iterator to access its data
-                 */
-                reference operator * () const {
-                    return *(p->_top[i] + j);
-                }
+        // ----------
+        // share_over
+        // ----------
 
-                // -----------
-                // operator ->
-                // -----------
+        /**
+         * @param that a MyDeque reference
+         * makes this MyDeque share the blocks of that in place of its own elements
+         * the blocks only this MyDeque owns stay in its outer container as the spares around the
+         * shared ones, and only those left over are freed, or allocated if too few
+         */
+        void share_over (const MyDeque& that) {
+            const_cast<MyDeque&>(that).settle();
+            settle();
+            size_type used = that._u_bottom - that._u_top + 1;
+            size_type m    = std::max(block_size, used);
+            size_type kept = 0;
+            for (size_type k = 0; k != block_size; ++k) {
+                kept += !shared(k);
+            }
 
-                /**
-                 * @return a pointer to an element
-                 * gives the address an iterator points to
-                 */
-                pointer operator -> () const {
-                    return &**this;
+            // everything that can throw comes before the first element goes
+            if (!that._r) {
+                that._r = r_allocator_type(_a).allocate(that.block_size);
+                std::fill(that._r, that._r + that.block_size, static_cast<size_type*>(0));
+            }
+            for (size_type s = that._u_top; s <= that._u_bottom; ++s) {
+                if (!that._r[s]) {
+                    that._r[s] = c_allocator_type(_a).allocate(1);
+                    *that._r[s] = 1;
                 }
+            }
+            std::vector<pointer> spare;
+            p_pointer            x = _top;
+            size_type**          r = _r;
+            try {
+                spare.reserve(std::max(kept, m - used));
+                while (spare.size() + kept < m - used) {
+                    spare.push_back(_a.allocate(BLOCK_WIDTH));
+                }
+                if (m != block_size) {
+                    x = _p.allocate(m);
+                }
+                if (m != block_size || !_r) {
+                    r = r_allocator_type(_a).allocate(m);
+                }
+            }
+            catch (...) {
+                for (size_type i = 0; i != spare.size(); ++i) {
+                    _a.deallocate(spare[i], BLOCK_WIDTH);
+                }
+                if (x != _top) {
+                    _p.deallocate(x, m);
+                }
+                throw;
+            }
 
-                // -----------
-                // operator ++
-                // -----------
-
-                /**
-                 * @return an iterator reference
-                 * increments an iterator by one
-                 */
-                iterator& operator ++ () {
-                    if (&p->_top[i][j] == &p->_top[i][BLOCK_WIDTH - 1]) {
-                        ++i;
-                        j = 0;
-                    }
-                    else {
-                        ++j;
-                    }
-                    
-                    assert(valid());
-                    return *this;
+            if (_top) {
+                drop(false);
+            }
+            for (size_type k = 0; k != block_size; ++k) {
+                if (shared(k)) {
+                    --*_r[k];
+                    continue;
+                }
+                if (_r && _r[k]) {
+                    c_allocator_type(_a).deallocate(_r[k], 1);
                 }
+                if (_top[k]) {
+                    spare.push_back(_top[k]);
+                }
+            }
+            if (x != _top && _top) {
+                _p.deallocate(_top, block_size);
+            }
+            if (r != _r && _r) {
+                r_allocator_type(_a).deallocate(_r, block_size);
+            }
 
-                /**
-                 * @return an iterator
-                 * gives a copy of an iterator and increments the original by one
-                 */
-                iterator operator ++ (int) {
-                    iterator x = *this;
-                    ++(*this);
-                    assert(valid());
-                    return x;
+            size_type base = (m - used) / 2;
+            for (size_type k = 0; k != m; ++k) {
+                if (base <= k && k < base + used) {
+                    size_type s = k - base + that._u_top;
+                    ++*that._r[s];
+                    r[k] = that._r[s];
+                    x[k] = that._top[s];
                 }
+                else {
+                    r[k] = 0;
+                    x[k] = spare.back();
+                    spare.pop_back();
+                }
+            }
+            for (size_type i = 0; i != spare.size(); ++i) {
+                _a.deallocate(spare[i], BLOCK_WIDTH);
+            }
+            _top = x;
+            _bottom = x + m;
+            _r = r;
+            block_size = m;
+            _u_top = base;
+            _u_bottom = base + used - 1;
+            _b = _top[_u_top] + (that._b - that._top[that._u_top]);
+            _e = _top[_u_bottom] + (that._e - that._top[that._u_bottom]);
+            _s = that._s;
+        }
 
-                // -----------
-                // operator --
-                // -----------
+        // ----
+        // drop
+        // ----
 
-                /**
-                 * @return an iterator reference
-                 * decrements an iterator by one
-                 */
-                iterator& operator -- () {
-                    if (&p->_top[i][j] == &p->_top[i][0]) {
-                        --i;
-                        j = BLOCK_WIDTH;
+        /**
+         * @param keep a bool
+         * destroys every element, handing shared blocks back to their other owners untouched
+         * a shared block is swapped for a fresh one if keep is true, or for 0
+         */
+        void drop (bool keep) {
+            settle();
+            for (size_type k = _u_top; k <= _u_bottom; ++k) {
+                if (shared(k)) {
+                    pointer old = _top[k];
+                    --*_r[k];
+                    _r[k] = 0;
+                    _top[k] = keep ? _a.allocate(BLOCK_WIDTH) : 0;
+                    if (keep && k == _u_top) {
+                        _b = _top[k] + (_b - old);
                     }
-                    else {
-                        --j;
+                    if (keep && k == _u_bottom) {
+                        _e = _top[k] + (_e - old);
                     }
-                    
-                    assert(valid());
-                    return *this;
+                    continue;
+                }
+                pointer b = (k == _u_top)    ? _b : _top[k];
+                pointer e = (k == _u_bottom) ? _e : _top[k] + BLOCK_WIDTH;
+                while (b != e) {
+                    traits_type::destroy(_a, b);
+                    ++b;
                 }
+            }
+        }
+
+        // -----------
+        // destroy_run
+        // -----------
+
+        /**
+         * @param b a pointer
+         * @param e a pointer
+         * destroys the elements in [b, e), doing nothing for trivially destructible types
+         */
+        void destroy_run (pointer b, pointer e) {
+            if (std::is_trivially_destructible<T>::value) {
+                return;
+            }
+            while (b != e) {
+                traits_type::destroy(_a, b);
+                ++b;
+            }
+        }
+
+        // -------
+        // release
+        // -------
+
+        /**
+         * @param k a size_type
+         * @param f a size_type
+         * @param l a size_type
+         * empties block k, whose elements sit at [f, l), so it can take new ones
+         * a shared block is handed back to its other owners whole and swapped for a fresh one
+         */
+        void release (size_type k, size_type f, size_type l) {
+            if (shared(k)) {
+                pointer x = _a.allocate(BLOCK_WIDTH);
+                --*_r[k];
+                _r[k] = 0;
+                _top[k] = x;
+                return;
+            }
+            pointer p = own(k);
+            destroy_run(p + f, p + l);
+        }
+
+        // --------
+        // prefetch
+        // --------
+
+        /**
+         * @param g a size_type
+         * asks the cache for the element g past the start of block _u_top
+         */
+        void prefetch (size_type g) const {
+#if defined(__GNUC__) && !defined(DEQUE_NO_PREFETCH)
+            __builtin_prefetch(_top[_u_top + g / BLOCK_WIDTH] + g % BLOCK_WIDTH);
+#endif
+        }
+
+        // --------------
+        // prefetch_block
+        // --------------
+
+        /**
+         * @param k a size_type
+         * asks the cache for the first lines of block k and for the map entry after it
+         * walks call it for the block prefetch_ahead past the one they step into, far enough
+         * ahead that small blocks arrive before the walk does
+         */
+        void prefetch_block (size_type k) const {
+#if defined(__GNUC__) && !defined(DEQUE_NO_PREFETCH)
+            if (k < block_size) {
+                const char*     b = reinterpret_cast<const char*>(_top[k]);
+                const size_type n = std::min<size_type>(BLOCK_WIDTH * sizeof(T), 8 * 64);
+                for (size_type d = 0; d < n; d += 64) {
+                    __builtin_prefetch(b + d);
+                }
+                if (k + 1 < block_size) {
+                    __builtin_prefetch(_top + k + 1);
+                }
+            }
+#else
+            (void) k;
+#endif
+        }
+
+        // ------------
+        // zip_segments
+        // ------------
+
+        /**
+         * @param lhs a MyDeque reference
+         * @param rhs a MyDeque reference
+         * @param n a size_type, at most the size of either
+         * @param f a function taking a run of k elements of lhs, the run of rhs beside it and k,
+         *          and returning false to stop
+         * @return a bool, false if f stopped
+         * walks the first n elements of both in lockstep, in runs that sit in one block of each
+         */
+        template <typename F>
+        static bool zip_segments (const MyDeque& lhs, const MyDeque& rhs, size_type n, F f) {
+            size_type     i = lhs._u_top;
+            size_type     j = rhs._u_top;
+            const_pointer p = lhs._b;
+            const_pointer q = rhs._b;
+            while (n) {
+                size_type k = std::min<size_type>(n, std::min(lhs._top[i] + BLOCK_WIDTH - p, rhs._top[j] + BLOCK_WIDTH - q));
+                if (!f(p, q, k)) {
+                    return false;
+                }
+                p += k;
+                q += k;
+                n -= k;
+                if (n && p == lhs._top[i] + BLOCK_WIDTH) {
+                    p = lhs._top[++i];
+                    lhs.prefetch_block(i + prefetch_ahead);
+                }
+                if (n && q == rhs._top[j] + BLOCK_WIDTH) {
+                    q = rhs._top[++j];
+                    rhs.prefetch_block(j + prefetch_ahead);
+                }
+            }
+            return true;
+        }
+
+        // ---------
+        // equal_run
+        // ---------
+
+        /**
+         * @param p a const_pointer to n elements
+         * @param q a const_pointer to n elements
+         * @param n a size_type
+         * @return a bool, whether the two runs hold equal elements
+         * skips a block the two share and otherwise tests the run with memcmp
+         */
+        static bool equal_run (const_pointer p, const_pointer q, size_type n, std::true_type) {
+            return (p == q) || !std::memcmp(p, q, n * sizeof(T));
+        }
+
+        static bool equal_run (const_pointer p, const_pointer q, size_type n, std::false_type) {
+            return std::equal(p, p + n, q);
+        }
+
+        // -----------
+        // compare_run
+        // -----------
+
+        /**
+         * @param p a const_pointer to n elements
+         * @param q a const_pointer to n elements
+         * @param n a size_type
+         * @return an int, less than, equal to or greater than 0 as [p, p + n) orders before, with
+         *         or after [q, q + n)
+         * skips a block the two share and otherwise tests the run with memcmp, then looks for the
+         * first element that differs only if memcmp found one
+         */
+        static int compare_run (const_pointer p, const_pointer q, size_type n, std::true_type) {
+            if (p == q || !std::memcmp(p, q, n * sizeof(T))) {
+                return 0;
+            }
+            std::pair<const_pointer, const_pointer> m = std::mismatch(p, p + n, q);
+            return (*m.first < *m.second) ? -1 : 1;
+        }
+
+        /**
+         * @param p a const_pointer to n elements
+         * @param q a const_pointer to n elements
+         * @param n a size_type
+         * @return an int, less than, equal to or greater than 0 as [p, p + n) orders before, with
+         *         or after [q, q + n)
+         * compares with < alone, element by element, as lexicographical_compare does
+         */
+        static int compare_run (const_pointer p, const_pointer q, size_type n, std::false_type) {
+            for (size_type i = 0; i != n; ++i) {
+                if (p[i] < q[i]) {
+                    return -1;
+                }
+                if (q[i] < p[i]) {
+                    return 1;
+                }
+            }
+            return 0;
+        }
+
+        // --------
+        // relocate
+        // --------
+
+        /**
+         * @param x a pointer to n empty slots
+         * @param p a pointer to n elements, not overlapping x
+         * @param n a size_type
+         * moves the n elements at p to x, leaving p empty
+         */
+        void relocate (pointer x, pointer p, size_type n) {
+            if (is_trivially_relocatable<T>::value) {
+                std::memcpy(static_cast<void*>(x), static_cast<const void*>(p), n * sizeof(T));
+                return;
+            }
+            for (size_type k = 0; k != n; ++k) {
+                traits_type::construct(_a, x + k, std::move(p[k]));
+                traits_type::destroy(_a, p + k);
+            }
+        }
+
+        // -----------
+        // shift_right
+        // -----------
+
+        /**
+         * @param d a size_type
+         * moves the elements from index d on one slot toward the back by copying their bytes, run by run
+         * leaves index d empty and the slot at _e holding the last element; only for relocatable T
+         */
+        void shift_right (size_type d) {
+            const size_type lo = (_b - _top[_u_top]) + d;
+            size_type       hi = (_b - _top[_u_top]) + size();
+            while (hi > lo) {
+                size_type k = (hi - 1) / BLOCK_WIDTH;
+                size_type b = std::max(lo, k * BLOCK_WIDTH);
+                size_type o = b % BLOCK_WIDTH;
+                pointer   x = own(_u_top + k);
+                if (hi % BLOCK_WIDTH == 0) {
+                    std::memcpy(static_cast<void*>(own(_u_top + k + 1)), static_cast<const void*>(x + BLOCK_WIDTH - 1), sizeof(T));
+                    std::memmove(static_cast<void*>(x + o + 1), static_cast<const void*>(x + o), (BLOCK_WIDTH - 1 - o) * sizeof(T));
+                }
+                else {
+                    std::memmove(static_cast<void*>(x + o + 1), static_cast<const void*>(x + o), (hi - b) * sizeof(T));
+                }
+                hi = b;
+            }
+        }
+
+        // ----------
+        // shift_left
+        // ----------
+
+        /**
+         * @param d a size_type
+         * moves the elements after index d one slot toward the front by copying their bytes, run by run
+         * index d must be empty already, and the last slot is left empty; only for relocatable T
+         */
+        void shift_left (size_type d) {
+            size_type       lo = (_b - _top[_u_top]) + d + 1;
+            const size_type hi = (_b - _top[_u_top]) + size();
+            while (lo < hi) {
+                size_type k = lo / BLOCK_WIDTH;
+                size_type e = std::min(hi, (k + 1) * BLOCK_WIDTH);
+                size_type o = lo % BLOCK_WIDTH;
+                pointer   x = own(_u_top + k);
+                if (o == 0) {
+                    std::memcpy(static_cast<void*>(own(_u_top + k - 1) + BLOCK_WIDTH - 1), static_cast<const void*>(x), sizeof(T));
+                    std::memmove(static_cast<void*>(x), static_cast<const void*>(x + 1), (e - lo - 1) * sizeof(T));
+                }
+                else {
+                    std::memmove(static_cast<void*>(x + o - 1), static_cast<const void*>(x + o), (e - lo) * sizeof(T));
+                }
+                lo = e;
+            }
+        }
+
+        // --------
+        // erase_at
+        // --------
+
+        /**
+         * @param d a size_type, less than size() - 1
+         * removes the element at index d by copying its successors' bytes down over it
+         */
+        void erase_at (size_type d, std::true_type) {
+            traits_type::destroy(_a, &*(begin() + d));
+            shift_left(d);
+            set_end(size() - 1);
+        }
+
+        /**
+         * @param d a size_type, less than size() - 1
+         * removes the element at index d by assigning each successor to the slot before it
+         */
+        void erase_at (size_type d, std::false_type) {
+            iterator p = begin() + d;
+            std::move(p + 1, end(), p);
+            pop_back();
+        }
+
+        // ---------
+        // insert_at
+        // ---------
+
+        /**
+         * @param d a size_type, less than size()
+         * @param v a const_reference
+         * adds v at index d after copying the bytes of the elements from d on up one slot
+         */
+        void insert_at (size_type d, const_reference v, std::true_type) {
+            value_type x(v);
+            if (_e == _top[_u_bottom] + BLOCK_WIDTH - 1) {
+                make_room(0, 1);
+            }
+            shift_right(d);
+            traits_type::construct(_a, &*(begin() + d), std::move(x));
+            set_end(size() + 1);
+        }
+
+        /**
+         * @param d a size_type, less than size()
+         * @param v a const_reference
+         * adds v at index d after assigning each element from d on to the slot after it
+         */
+        void insert_at (size_type d, const_reference v, std::false_type) {
+            value_type x(v);
+            push_back(std::move(back()));
+            iterator p = begin() + d;
+            std::move_backward(p, end() - 2, end() - 1);
+            *p = std::move(x);
+        }
+
+        // --------
+        // put_back
+        // --------
+
+        /**
+         * @param v a value to construct the new last element from
+         * @return a bool, false if a full bounded MyDeque rejected v
+         * v is copied out before a full MyDeque drops its first element, since it may be that one
+         */
+        template <typename U>
+        bool put_back (U&& v) {
+            if (full()) {
+                if (_policy == reject_newest) {
+                    return false;
+                }
+                value_type x(std::forward<U>(v));
+                pop_front();
+                return put_back(std::move(x));
+            }
+            if (!_top || _e == _top[_u_bottom] + BLOCK_WIDTH - 1) {
+                make_room(0, 1);
+            }
+            if (_g.map) {
+                grow_step(GROWTH_STEP);
+            }
+            own(_u_bottom);
+            traits_type::construct(_a, _e, std::forward<U>(v));
+            if (++_e == _top[_u_bottom] + BLOCK_WIDTH) {
+                ++_u_bottom;
+                _e = _top[_u_bottom];
+            }
+            ++_s;
+            assert(valid());
+            return true;
+        }
+
+        // ---------
+        // put_front
+        // ---------
+
+        /**
+         * @param v a value to construct the new first element from
+         * @return a bool, false if a full bounded MyDeque rejected v
+         * v is copied out before a full MyDeque drops its last element, since it may be that one
+         */
+        template <typename U>
+        bool put_front (U&& v) {
+            if (full()) {
+                if (_policy == reject_newest) {
+                    return false;
+                }
+                value_type x(std::forward<U>(v));
+                pop_back();
+                return put_front(std::move(x));
+            }
+            if (!_top || _b == _top[_u_top]) {
+                make_room(1, 0);
+            }
+            if (_g.map) {
+                grow_step(GROWTH_STEP);
+            }
+            if (_b == _top[_u_top]) {
+                traits_type::construct(_a, own(_u_top - 1) + BLOCK_WIDTH - 1, std::forward<U>(v));
+                --_u_top;
+                _b = _top[_u_top] + BLOCK_WIDTH - 1;
+            }
+            else {
+                own(_u_top);
+                traits_type::construct(_a, _b - 1, std::forward<U>(v));
+                --_b;
+            }
+            ++_s;
+
+            assert(valid());
+            return true;
+        }
+
+        // ------------
+        // swap_storage
+        // ------------
+
+        /**
+         * @param rhs a MyDeque reference
+         * trades blocks and outer containers with rhs, leaving both modes alone
+         */
+        void swap_storage (MyDeque& rhs) {
+            settle();
+            rhs.settle();
+            std::swap(_top, rhs._top);
+            std::swap(_bottom, rhs._bottom);
+            std::swap(_u_top, rhs._u_top);
+            std::swap(_u_bottom, rhs._u_bottom);
+            std::swap(block_size, rhs.block_size);
+            std::swap(_b, rhs._b);
+            std::swap(_e, rhs._e);
+            std::swap(_s, rhs._s);
+            std::swap(_r, rhs._r);
+        }
+
+        // ---------
+        // adopt_map
+        // ---------
+
+        /**
+         * @param x an outer container
+         * @param m a size_type
+         * replaces the outer container with x, which holds m blocks
+         */
+        void adopt_map (p_pointer x, size_type m) {
+            _p.deallocate(_top, block_size);
+            _top = x;
+            _bottom = x + m;
+            block_size = m;
+        }
+
+        // ----------
+        // forget_map
+        // ----------
+
+        /**
+         * lets go of the outer container, whose blocks now belong to another MyDeque
+         */
+        void forget_map () {
+            _p.deallocate(_top, block_size);
+            _top = _bottom = 0;
+            _b = _e = 0;
+            _s = 0;
+            block_size = _u_top = _u_bottom = 0;
+        }
+
+        // ---------
+        // adoptable
+        // ---------
+
+        /**
+         * @param that a MyDeque reference
+         * @return a bool
+         * checks if blocks of that can be handed to this MyDeque as they are
+         */
+        bool adoptable (const MyDeque& that) const {
+            return _a == that._a && _p == that._p && !_limit && !that._limit;
+        }
+
+        // -----------
+        // reserve_map
+        // -----------
+
+        /**
+         * @param front a size_type
+         * @param back a size_type
+         * makes sure there are at least front blocks before _u_top and back blocks after _u_bottom
+         * recenters the blocks in place when the outer container is at most half used,
+         * otherwise moves the blocks into an outer container twice as big
+         */
+        void reserve_map (size_type front, size_type back) {
+            settle();
+            if (!_top) {
+                block_size = front + back + 1;
+                _top = _p.allocate(block_size);
+                _bottom = _top + block_size;
+                for (p_pointer p = _top; p != _bottom; ++p) {
+                    *p = _a.allocate(BLOCK_WIDTH);
+                }
+                _u_top = _u_bottom = front;
+                _b = _e = _top[front];
+                return;
+            }
+            if (_u_top >= front && block_size - _u_bottom - 1 >= back) {
+                return;
+            }
+
+            size_type used = _u_bottom - _u_top + 1;
+            size_type n    = used + front + back;
+            if (2 * n <= block_size) {
+                size_type t = front + (block_size - n) / 2;
+                size_type r = (t < _u_top) ? _u_top - t : block_size - (t - _u_top);
+                std::rotate(_top, _top + r, _bottom);
+                if (_r) {
+                    std::rotate(_r, _r + r, _r + block_size);
+                }
+                _u_top = t;
+                _u_bottom = t + used - 1;
+            }
+            else {
+                assert(!_limit);
+                size_type m = std::max(2 * block_size, 2 * n);
+                size_type t = front + (m - n) / 2;
+                p_pointer x = _p.allocate(m);
+                size_type** y = _r ? r_allocator_type(_a).allocate(m) : 0;
+                size_type spare = 0;
+                for (size_type k = 0; k != m; ++k) {
+                    size_type s = k - t + _u_top;
+                    if (k < t || k >= t + used) {
+                        if (spare == _u_top) {
+                            spare += used;
+                        }
+                        s = (spare != block_size) ? spare++ : block_size;
+                    }
+                    x[k] = (s != block_size) ? _top[s] : _a.allocate(BLOCK_WIDTH);
+                    if (y) {
+                        y[k] = (s != block_size) ? _r[s] : 0;
+                    }
+                }
+                if (_r) {
+                    r_allocator_type(_a).deallocate(_r, block_size);
+                    _r = y;
+                }
+                _p.deallocate(_top, block_size);
+                _top = x;
+                _bottom = x + m;
+                block_size = m;
+                _u_bottom = t + used - 1;
+                _u_top = t;
+            }
+            assert(valid());
+        }
+
+        // ---------
+        // make_room
+        // ---------
+
+        /**
+         * @param front a size_type
+         * @param back a size_type
+         * reserve_map for a single push: while gradual growth is under way it is a no-op as long
+         * as the blocks needed sit in both outer containers, and a crowded outer container starts
+         * gradual growth instead of growing at once
+         */
+        void make_room (size_type front, size_type back) {
+            if (_gradual && _top && !_g.map && !_r && !_limit && block_size >= 8 * GROWTH_STEP) {
+                size_type slack = block_size / 8;
+                if (_u_top < slack || block_size - _u_bottom - 1 < slack) {
+                    begin_growth();
+                }
+            }
+            if (_g.map && _u_top >= front && _u_bottom + back < block_size &&
+                    static_cast<difference_type>(_u_top - front) + _g.shift >= 0 &&
+                    static_cast<difference_type>(_u_bottom + back) + _g.shift < static_cast<difference_type>(_g.size)) {
+                return;
+            }
+            reserve_map(front, back);
+        }
+
+        // ------------
+        // begin_growth
+        // ------------
+
+        /**
+         * starts moving the blocks into a new outer container with the used blocks centered,
+         * twice as big if more than half of this one is used, otherwise the same size
+         * the blocks that end up outside it fill the new slots at the other end
+         */
+        void begin_growth () {
+            size_type used = _u_bottom - _u_top + 1;
+            _g.size  = (2 * used > block_size) ? 2 * block_size : block_size;
+            _g.map   = _p.allocate(_g.size);
+            _g.done  = 0;
+            _g.shift = static_cast<difference_type>((_g.size - used) / 2) - static_cast<difference_type>(_u_top);
+            if (_g.shift < 0) {
+                _g.spare = 0;
+                _g.last  = -_g.shift;
+            }
+            else {
+                _g.spare = std::min<size_type>(block_size, _g.size - _g.shift);
+                _g.last  = block_size;
+            }
+        }
+
+        // ---------
+        // grow_step
+        // ---------
+
+        /**
+         * @param n a size_type
+         * fills in the next n slots of the new outer container and switches to it once it is full
+         */
+        void grow_step (size_type n) {
+            for (; n && _g.done != _g.size; --n, ++_g.done) {
+                difference_type k = static_cast<difference_type>(_g.done) - _g.shift;
+                if (k >= 0 && k < static_cast<difference_type>(block_size)) {
+                    _g.map[_g.done] = _top[k];
+                }
+                else if (_g.spare != _g.last) {
+                    _g.map[_g.done] = _top[_g.spare++];
+                }
+                else {
+                    _g.map[_g.done] = _a.allocate(BLOCK_WIDTH);
+                }
+            }
+            if (_g.done == _g.size) {
+                _p.deallocate(_top, block_size);
+                _top       = _g.map;
+                _bottom    = _top + _g.size;
+                block_size = _g.size;
+                _u_top    += _g.shift;
+                _u_bottom += _g.shift;
+                _g         = growth();
+                assert(valid());
+            }
+        }
+
+        // ------
+        // settle
+        // ------
+
+        /**
+         * finishes a gradual growth under way at once
+         */
+        void settle () {
+            if (_g.map) {
+                grow_step(_g.size);
+            }
+        }
+
+        // ------
+        // cursor
+        // ------
+
+        /**
+         * walks the elements of an outer container by their offset from its start,
+         * only touching the outer container when it crosses into the next block
+         */
+        struct cursor {
+            p_pointer m;
+            size_type g;
+            size_type limit;
+            pointer   q;
+
+            cursor (p_pointer x, size_type y, size_type z) :
+                    m (x), g (y), limit (z), q (x[y / BLOCK_WIDTH] + y % BLOCK_WIDTH)
+                {}
+
+            void advance () {
+                if (++g % BLOCK_WIDTH != 0) {
+                    ++q;
+                }
+                else if (g != limit) {
+                    q = m[g / BLOCK_WIDTH];
+                }
+            }
+        };
+
+        // -------------
+        // destroy_range
+        // -------------
+
+        /**
+         * @param m an outer container
+         * @param lo a size_type
+         * @param hi a size_type
+         * destroys the elements of m at offsets [lo, hi)
+         */
+        void destroy_range (p_pointer m, size_type lo, size_type hi) {
+            for (size_type g = lo; g != hi; ++g) {
+                traits_type::destroy(_a, m[g / BLOCK_WIDTH] + g % BLOCK_WIDTH);
+            }
+        }
+
+        // ----------
+        // copy_slots
+        // ----------
+
+        /**
+         * @param g a size_type
+         * @param n a size_type
+         * @param f an input iterator, left just past the values it gave
+         * assigns n values from f over the elements at offsets [g, g + n) of the outer container
+         */
+        template <typename I>
+        void copy_slots (size_type g, size_type n, I& f) {
+            if (!n) {
+                return;
+            }
+            for (size_type k = g / BLOCK_WIDTH; k <= (g + n - 1) / BLOCK_WIDTH; ++k) {
+                own(k);
+            }
+            cursor c(_top, g, block_size * BLOCK_WIDTH);
+            for (size_type i = 0; i != n; ++i, ++f) {
+                *c.q = *f;
+                c.advance();
+            }
+        }
+
+        // ----------
+        // fill_slots
+        // ----------
+
+        /**
+         * @param g a size_type
+         * @param n a size_type
+         * @param f an input iterator, left just past the values it gave
+         * constructs n elements from f in the free slots at offsets [g, g + n) of the outer
+         * container, destroying them again if one throws
+         */
+        template <typename I>
+        void fill_slots (size_type g, size_type n, I& f) {
+            if (!n) {
+                return;
+            }
+            for (size_type k = g / BLOCK_WIDTH; k <= (g + n - 1) / BLOCK_WIDTH; ++k) {
+                own(k);
+            }
+            cursor c(_top, g, block_size * BLOCK_WIDTH);
+            try {
+                for (size_type i = 0; i != n; ++i, ++f) {
+                    traits_type::construct(_a, c.q, *f);
+                    c.advance();
+                }
+            }
+            catch (...) {
+                destroy_range(_top, g, c.g);
+                throw;
+            }
+        }
+
+        // --------
+        // assign_n
+        // --------
+
+        /**
+         * @param f an input iterator to n values
+         * @param n a size_type
+         * @throws length_error if a bounded MyDeque can't hold n elements
+         * makes a MyDeque hold the n values from f in the blocks it already has
+         * assigns over the elements there, constructs the rest in the free slots after the last
+         * element and then before the first, and only reserves more blocks when those run out
+         */
+        template <typename I>
+        void assign_n (I f, size_type n) {
+            if (_limit && n > _limit) {
+                throw std::length_error("size exceeds the capacity of a bounded MyDeque");
+            }
+            settle();
+            size_type s = size();
+            if (n <= s) {
+                if (n) {
+                    copy_slots(_u_top * BLOCK_WIDTH + (_b - _top[_u_top]), n, f);
+                }
+                pop_back_n(s - n);
+                assert(valid());
+                return;
+            }
+            size_type need  = n - s;
+            size_type front = 0;
+            if (!_top) {
+                reserve_map(0, n / BLOCK_WIDTH);
+            }
+            else {
+                size_type h = _u_top * BLOCK_WIDTH + (_b - _top[_u_top]);
+                size_type t = (block_size - _u_bottom) * BLOCK_WIDTH - (_e - _top[_u_bottom]) - 1;
+                if (need <= t + h) {
+                    front = need - std::min(need, t);
+                }
+                else {
+                    reserve_map(0, _u_top + ((_b - _top[_u_top]) + n) / BLOCK_WIDTH - _u_bottom);
+                }
+            }
+            if (front) {
+                size_type g = _u_top * BLOCK_WIDTH + (_b - _top[_u_top]) - front;
+                fill_slots(g, front, f);
+                _u_top = g / BLOCK_WIDTH;
+                _b = _top[_u_top] + g % BLOCK_WIDTH;
+                _s += front;
+            }
+            copy_slots(_u_top * BLOCK_WIDTH + (_b - _top[_u_top]) + front, s, f);
+            fill_slots(_u_bottom * BLOCK_WIDTH + (_e - _top[_u_bottom]), need - front, f);
+            set_end(n);
+            assert(valid());
+        }
+
+        // ------
+        // repeat
+        // ------
+
+        /**
+         * an input iterator that gives the same value forever, for assign(n, v)
+         */
+        struct repeat {
+            const_pointer v;
+
+            const_reference operator * () const {
+                return *v;
+            }
+
+            repeat& operator ++ () {
+                return *this;
+            }
+        };
+
+        // -----------
+        // sort_blocks
+        // -----------
+
+        /**
+         * @param c a binary predicate
+         * @param f a size_type
+         * @param l a size_type
+         * @param stable a bool
+         * sorts each of the blocks [f, l) in place
+         */
+        template <typename C>
+        void sort_blocks (C c, size_type f, size_type l, bool stable) {
+            for (size_type k = f; k != l; ++k) {
+                pointer b = (k == _u_top)    ? _b : _top[k];
+                pointer e = (k == _u_bottom) ? _e : _top[k] + BLOCK_WIDTH;
+                if (stable) {
+                    std::stable_sort(b, e, c);
+                }
+                else {
+                    std::sort(b, e, c);
+                }
+            }
+        }
+
+        // -----------
+        // merge_runs
+        // -----------
+
+        /**
+         * @param c a binary predicate
+         * @param s the outer container being read
+         * @param d the outer container being written
+         * @param lo a size_type
+         * @param mid a size_type
+         * @param hi a size_type
+         * @param built a bool, true if d already holds constructed elements
+         * merges the sorted runs [lo, mid) and [mid, hi) of s into [lo, hi) of d
+         */
+        template <typename C>
+        void merge_runs (C c, p_pointer s, p_pointer d, size_type lo, size_type mid, size_type hi, bool built) {
+            cursor x(s, lo, mid);
+            cursor o(d, lo, hi);
+            if (mid == hi) {
+                while (x.g != mid) {
+                    place(o.q, *x.q, built);
+                    x.advance();
+                    o.advance();
+                }
+                return;
+            }
+            cursor y(s, mid, hi);
+            while (x.g != mid && y.g != hi) {
+                if (c(*y.q, *x.q)) {
+                    place(o.q, *y.q, built);
+                    y.advance();
+                }
+                else {
+                    place(o.q, *x.q, built);
+                    x.advance();
+                }
+                o.advance();
+            }
+            for (; x.g != mid; x.advance(), o.advance()) {
+                place(o.q, *x.q, built);
+            }
+            for (; y.g != hi; y.advance(), o.advance()) {
+                place(o.q, *y.q, built);
+            }
+        }
+
+        // -----
+        // place
+        // -----
+
+        /**
+         * @param p a pointer
+         * @param v a reference
+         * @param built a bool
+         * moves v into p, constructing it unless p already holds an element
+         */
+        void place (pointer p, reference v, bool built) {
+            if (built) {
+                *p = std::move(v);
+            }
+            else {
+                traits_type::construct(_a, p, std::move(v));
+            }
+        }
+
+        // ------------
+        // segment_sort
+        // ------------
+
+        /**
+         * @param c a binary predicate
+         * @param threads a size_type
+         * @param stable a bool
+         * sorts every block in place, then merges the blocks pairwise back and forth
+         * between the outer container and a fresh set of blocks
+         */
+        template <typename C>
+        void segment_sort (C c, size_type threads, bool stable) {
+            if (!_top || empty()) {
+                return;
+            }
+            detach();
+
+            size_type blocks = _u_bottom - _u_top + 1;
+            threads = std::max<size_type>(1, std::min(threads, blocks));
+            if (threads == 1) {
+                sort_blocks(c, _u_top, _u_bottom + 1, stable);
+            }
+            else {
+                std::vector<std::thread> workers;
+                size_type step = (blocks + threads - 1) / threads;
+                for (size_type k = _u_top; k <= _u_bottom; k += step) {
+                    size_type l = std::min(k + step, _u_bottom + 1);
+                    workers.push_back(std::thread([this, c, k, l, stable] () {sort_blocks(c, k, l, stable);}));
+                }
+                for (size_type k = 0; k != workers.size(); ++k) {
+                    workers[k].join();
+                }
+            }
+            size_type lo = _u_top * BLOCK_WIDTH + (_b - _top[_u_top]);
+            size_type hi = lo + size();
+            if (lo / BLOCK_WIDTH == (hi - 1) / BLOCK_WIDTH) {
+                return;
+            }
+
+            p_pointer s = _top;
+            p_pointer d = _p.allocate(block_size);
+            for (size_type k = 0; k != block_size; ++k) {
+                d[k] = (k < _u_top || k > _u_bottom) ? _top[k] : _a.allocate(BLOCK_WIDTH);
+            }
+
+            bool built = false;
+            for (size_type w = BLOCK_WIDTH; lo / w != (hi - 1) / w; w *= 2) {
+                std::vector<size_type> pairs;
+                for (size_type m = lo / (2 * w) * (2 * w); m < hi; m += 2 * w) {
+                    pairs.push_back(m);
+                }
+                size_type n = std::min<size_type>(threads, pairs.size());
+                size_type step = (pairs.size() + n - 1) / n;
+                std::vector<std::thread> workers;
+                for (size_type f = 0; f < pairs.size(); f += step) {
+                    size_type l = std::min<size_type>(f + step, pairs.size());
+                    if (n == 1) {
+                        merge_pass(c, s, d, pairs, f, l, w, lo, hi, built);
+                    }
+                    else {
+                        workers.push_back(std::thread([this, c, s, d, &pairs, f, l, w, lo, hi, built] () {merge_pass(c, s, d, pairs, f, l, w, lo, hi, built);}));
+                    }
+                }
+                for (size_type k = 0; k != workers.size(); ++k) {
+                    workers[k].join();
+                }
+                built = true;
+                std::swap(s, d);
+            }
+
+            destroy_range(d, lo, hi);
+            for (size_type k = _u_top; k <= _u_bottom; ++k) {
+                _a.deallocate(d[k], BLOCK_WIDTH);
+            }
+            _p.deallocate(d, block_size);
+
+            if (s != _top) {
+                _top    = s;
+                _bottom = _top + block_size;
+                _b      = _top[_u_top] + lo % BLOCK_WIDTH;
+                set_end(hi - lo);
+            }
+            assert(valid());
+        }
+
+        // ----------
+        // merge_pass
+        // ----------
+
+        /**
+         * merges the run pairs starting at pairs[f, l) that are w elements wide
+         */
+        template <typename C>
+        void merge_pass (C c, p_pointer s, p_pointer d, const std::vector<size_type>& pairs,
+                         size_type f, size_type l, size_type w, size_type lo, size_type hi, bool built) {
+            for (size_type k = f; k != l; ++k) {
+                size_type m   = pairs[k];
+                size_type b   = std::max(lo, m);
+                size_type mid = std::max(b, std::min(hi, m + w));
+                size_type e   = std::min(hi, m + 2 * w);
+                merge_runs(c, s, d, b, mid, e, built);
+            }
+        }
+
+    public:
+        // --------
+        // iterator
+        // --------
+
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::random_access_iterator_tag  iterator_category;
+                typedef typename MyDeque::value_type      value_type;
+                typedef typename MyDeque::difference_type difference_type;
+                typedef typename MyDeque::pointer         pointer;
+                typedef typename MyDeque::reference       reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a bool
+                 * checks to see if two iterators are equal to each other
+                 */
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return lhs.position() == rhs.position();
+                }
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a bool
+                 * checks to see if two iterators are not equal to each other
+                 */
+                friend bool operator != (const iterator& lhs, const iterator& rhs) {
+                    return !(lhs == rhs);
+                }
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * @param lhs an iterator
+                 * @param rhs a difference_type
+                 * @return an iterator
+                 * increments an iterator by rhs
+                 */
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;
+                }
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * @param lhs an iterator
+                 * @param rhs a difference_type
+                 * @return an iterator
+                 * decrements an iterator by rhs
+                 */
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;
+                }
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a difference_type
+                 * gives the number of elements between two iterators
+                 */
+                friend difference_type operator - (const iterator& lhs, const iterator& rhs) {
+                    return lhs.position() - rhs.position();
+                }
+
+                // ----------
+                // operator <
+                // ----------
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a bool
+                 * checks to see if lhs comes before rhs
+                 */
+                friend bool operator < (const iterator& lhs, const iterator& rhs) {
+                    return lhs.position() < rhs.position();
+                }
+
+            private:
+                // ----
+                // data
+                // ----
+
+                MyDeque*  p;
+                size_type i;
+                size_type j;
+
+            private:
+                // -----
+                // valid
+                // -----
+
+                bool valid () const {
+                    return j <= BLOCK_WIDTH;
+                }
+
+                // --------
+                // position
+                // --------
+
+                /**
+                 * @return a difference_type
+                 * gives the offset of the element from the start of the outer container
+                 */
+                difference_type position () const {
+                    return i * BLOCK_WIDTH + j;
+                }
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param x a MyDeque pointer
+                 * @param y a size_type
+                 * @param z a size_type
+                 * @return a new iterator
+                 * constructs a new iterator pointing to an element's address
+                 */
+                iterator (MyDeque* x, size_type y, size_type z) : p(x) {
+                    i = y;
+                    j = z;
+                    assert(valid());
+                }
+
+                // Default copy, destructor, and copy assignment.
+                // iterator (const iterator&);
+                // ~iterator ();
+                // iterator& operator = (const iterator&);
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return a reference to the element being pointed to
+                 * dereferences an iterator to access its data
+                 */
+                reference operator * () const {
+                    return *(p->own(i) + j);
+                }
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return a pointer to an element
+                 * gives the address an iterator points to
+                 */
+                pointer operator -> () const {
+                    return &**this;
+                }
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * @return an iterator reference
+                 * increments an iterator by one
+                 */
+                iterator& operator ++ () {
+                    if (++j >= BLOCK_WIDTH) {
+                        ++i;
+                        j = 0;
+                        p->prefetch_block(i + prefetch_ahead);
+                    }
+
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return an iterator
+                 * gives a copy of an iterator and increments the original by one
+                 */
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++(*this);
+                    assert(valid());
+                    return x;
+                }
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * @return an iterator reference
+                 * decrements an iterator by one
+                 */
+                iterator& operator -- () {
+                    if (j == 0) {
+                        --i;
+                        j = BLOCK_WIDTH - 1;
+                    }
+                    else {
+                        --j;
+                    }
+
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return an iterator
+                 * gives a copy of an iterator and decrements the original by one
+                 */
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --(*this);
+                    assert(valid());
+                    return x;
+                }
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return an iterator reference
+                 * increments an iterator by d
+                 */
+                iterator& operator += (difference_type d) {
+                    difference_type n = position() + d;
+                    i = n / BLOCK_WIDTH;
+                    j = n % BLOCK_WIDTH;
+
+                    assert(valid());
+                    return *this;
+                }
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return an iterator reference
+                 * decrements an iterator by d
+                 */
+                iterator& operator -= (difference_type d) {
+                    return *this += -d;
+                }
+
+                // -----------
+                // operator []
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a reference to the element d past the one being pointed to
+                 */
+                reference operator [] (difference_type d) const {
+                    return *(*this + d);
+                }
+        };
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::random_access_iterator_tag  iterator_category;
+                typedef typename MyDeque::value_type      value_type;
+                typedef typename MyDeque::difference_type difference_type;
+                typedef typename MyDeque::const_pointer   pointer;
+                typedef typename MyDeque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a bool
+                 * checks to see if two const_iterators are equal to each other
+                 */
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.position() == rhs.position();
+                }
+
+                /**
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a bool
+                 * checks to see if two const_iterators are not equal to each other
+                 */
+                friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
+                    return !(lhs == rhs);
+                }
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * @param lhs a const_iterator
+                 * @param rhs a difference_type
+                 * @return a const_iterator
+                 * increments a const_iterator by rhs
+                 */
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;
+                }
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * @param lhs a const_iterator
+                 * @param rhs a difference_type
+                 * @return a const_iterator
+                 * decrements a const_iterator by rhs
+                 */
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;
+                }
+
+                /**
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a difference_type
+                 * gives the number of elements between two const_iterators
+                 */
+                friend difference_type operator - (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.position() - rhs.position();
+                }
+
+                // ----------
+                // operator <
+                // ----------
 
                 /**
-                 * @return an iterator
-                 * gives a copy of an iterator and decrements the original by one
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a bool
+                 * checks to see if lhs comes before rhs
                  */
-                iterator operator -- (int) {
-                    iterator x = *this;
+                friend bool operator < (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.position() < rhs.position();
+                }
+
+            private:
+                // ----
+                // data
+                // ----
+
+                const MyDeque*  p;
+                size_type i;
+                size_type j;
+
+            private:
+                // -----
+                // valid
+                // -----
+
+                bool valid () const {
+                    return j <= BLOCK_WIDTH;
+                }
+
+                // --------
+                // position
+                // --------
+
+                /**
+                 * @return a difference_type
+                 * gives the offset of the element from the start of the outer container
+                 */
+                difference_type position () const {
+                    return i * BLOCK_WIDTH + j;
+                }
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param x a MyDeque pointer
+                 * @param y a size_type
+                 * @param z a size_type
+                 * @return a new const_iterator
+                 * constructs a new const_iterator pointing to an element's address
+                 */
+                const_iterator (const MyDeque* x, size_type y, size_type z) : p(x) {
+                    i = y;
+                    j = z;
+                    assert(valid());
+                }
+
+                // Default copy, destructor, and copy assignment.
+                // const_iterator (const const_iterator&);
+                // ~const_iterator ();
+                // const_iterator& operator = (const const_iterator&);
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return a reference to the element being pointed to
+                 * dereferences a const_iterator to access its data
+                 */
+                reference operator * () const {
+                    return p->_top[i][j];
+                }
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return a pointer to an element
+                 * gives the address a const_iterator points to
+                 */
+                pointer operator -> () const {
+                    return &**this;
+                }
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * @return a const_iterator reference
+                 * increments a const_iterator by one
+                 */
+                const_iterator& operator ++ () {
+                    if (++j >= BLOCK_WIDTH) {
+                        ++i;
+                        j = 0;
+                        p->prefetch_block(i + prefetch_ahead);
+                    }
+
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return a const_iterator
+                 * gives a copy of a const_iterator and increments the original by one
+                 */
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    assert(valid());
+                    return x;
+                }
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * @return a const_iterator reference
+                 * decrements a const_iterator by one
+                 */
+                const_iterator& operator -- () {
+                    if (j == 0) {
+                        --i;
+                        j = BLOCK_WIDTH - 1;
+                    }
+                    else {
+                        --j;
+                    }
+
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return a const_iterator
+                 * gives a copy of a const_iterator and decrements the original by one
+                 */
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
                     --(*this);
                     assert(valid());
                     return x;
                 }
 
-                // -----------
-                // operator +=
-                // -----------
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a const_iterator reference
+                 * increments a const_iterator by d
+                 */
+                const_iterator& operator += (difference_type d) {
+                    difference_type n = position() + d;
+                    i = n / BLOCK_WIDTH;
+                    j = n % BLOCK_WIDTH;
+
+                    assert(valid());
+                    return *this;
+                }
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a const_iterator reference
+                 * decrements a const_iterator by d
+                 */
+                const_iterator& operator -= (difference_type d) {
+                    return *this += -d;
+                }
+
+                // -----------
+                // operator []
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a const_reference to the element d past the one being pointed to
+                 */
+                reference operator [] (difference_type d) const {
+                    return *(*this + d);
+                }
+        };
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param a an allocator_type reference
+         * @return a MyDeque object
+         * makes a new MyDeque object from an allocator_type
+         */
+        explicit MyDeque (const allocator_type& a = allocator_type()) :
+                _a (a), _p (a) {
+            _top = _bottom = 0;
+            _b = _e = 0;
+            _s = 0;
+            block_size = _u_top = _u_bottom = 0;
+            _limit = 0;
+            _policy = overwrite_oldest;
+            _r = 0;
+            _cow = false;
+            _gradual = false;
+            
+            assert(valid());
+        }
+
+        /**
+         * @param c a size_type
+         * @param p an overflow_policy
+         * @param a an allocator_type reference
+         * @return a MyDeque object
+         * @throws length_error if c is 0, since a _limit of 0 means unbounded
+         * makes a new empty MyDeque that never holds more than c elements
+         * every block it will ever use is allocated here and recycled from one end to the other,
+         * so pushes and pops never allocate or free
+         */
+        MyDeque (size_type c, overflow_policy p, const allocator_type& a = allocator_type()) :
+                _a (a), _p (a) {
+            if (!c) {
+                throw std::length_error("a bounded MyDeque needs a capacity of at least 1");
+            }
+            _top = _bottom = 0;
+            _b = _e = 0;
+            _s = 0;
+            block_size = _u_top = _u_bottom = 0;
+            _limit = c;
+            _policy = p;
+            _r = 0;
+            _cow = false;
+            _gradual = false;
+
+            size_type blocks = c / BLOCK_WIDTH + 3;
+            reserve_map(blocks, blocks - 1);
+
+            assert(valid());
+        }
+
+        /**
+         * @param s a size_type
+         * @param v a const_reference
+         * @param a an allocator_type reference
+         * @return a MyDeque object
+         * makes a new MyDeque object of size s and fills it with value v
+         */
+        explicit MyDeque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+                _a (a), _p (a) {
+
+            size_type num_blocks = s / BLOCK_WIDTH + 1;
+            block_size = num_blocks;
+            _limit = 0;
+            _policy = overwrite_oldest;
+            _r = 0;
+            _cow = false;
+            _gradual = false;
+
+            _top = _p.allocate(num_blocks);
+            _bottom = _top + num_blocks;
+            
+            p_pointer temp = _top;
+            while (_top != _bottom) {
+                *_top = _a.allocate(BLOCK_WIDTH);
+                ++_top;
+            }
+            _top = temp;
+            
+            _b = _top[0];
+            _u_top = 0;
+            set_end(s);
+
+            uninitialized_fill(_a, begin(), end(), v);
+            
+            assert(valid());
+        }
+
+        /**
+         * @param that a MyDeque reference
+         * @return a MyDeque object
+         * makes a new MyDeque object with the contents of another MyDeque object
+         * if that is copy_on_write the two share blocks until either one writes to them
+         */
+        MyDeque (const MyDeque& that) :
+                _a (that._a), _p (that._p) {
+            _limit = that._limit;
+            _policy = that._policy;
+            _r = 0;
+            _cow = that._cow;
+            _gradual = that._gradual;
+            if (!that._top) {
+                _top = _bottom = 0;
+                _b = _e = 0;
+                _s = 0;
+                block_size = _u_top = _u_bottom = 0;
+                return;
+            }
+            if (_cow) {
+                share(that);
+                assert(valid());
+                return;
+            }
+            _top = _p.allocate(that.block_size);
+            _bottom = _top + that.block_size;
+                        
+            block_size = that.block_size;
+                        
+            p_pointer temp = _top;
+            while (_top != _bottom) {
+                *_top = _a.allocate(BLOCK_WIDTH);
+                ++_top;
+            }
+            _top = temp;
+
+            _u_top = that._u_top;
+            _u_bottom = that._u_bottom;
+            
+            _b = _top[_u_top] + (that._b - that._top[that._u_top]);
+            _e = _top[_u_bottom] + (that._e - that._top[that._u_bottom]);
+            _s = that._s;
+            
+            uninitialized_copy(_a, that.begin(), that.end(), begin());
+                    
+            assert(valid());
+        }
+
+        /**
+         * @param that a MyDeque rvalue reference
+         * @return a MyDeque object
+         * makes a new MyDeque object that takes over the blocks of another MyDeque object
+         * that is left an empty unbounded MyDeque, since its bound went with its blocks
+         */
+        MyDeque (MyDeque&& that) :
+                _a (that._a), _p (that._p) {
+            _top = _bottom = 0;
+            _b = _e = 0;
+            _s = 0;
+            block_size = _u_top = _u_bottom = 0;
+            _limit = that._limit;
+            _policy = that._policy;
+            _r = 0;
+            _cow = that._cow;
+            _gradual = that._gradual;
+            swap_storage(that);
+            that._limit = 0;
+
+            assert(valid());
+        }
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * destroys a MyDeque object
+         */
+        ~MyDeque () {
+            if (_top) {
+                drop(false);
+                
+                for (size_type k = 0; k != block_size; ++k) {
+                    if (shared(k)) {
+                        --*_r[k];
+                        continue;
+                    }
+                    if (_top[k]) {
+                        _a.deallocate(_top[k], BLOCK_WIDTH);
+                    }
+                    if (_r && _r[k]) {
+                        c_allocator_type(_a).deallocate(_r[k], 1);
+                    }
+                }
+                if (_r) {
+                    r_allocator_type(_a).deallocate(_r, block_size);
+                }
+                
+                _p.deallocate(_top, block_size);
+                _top = _bottom = 0;
+                _b = _e = 0;
+                _s = 0;
+            }
+            
+            assert(valid());
+        }
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * @param rhs a MyDeque reference
+         * @return a MyDeque reference
+         * assigns the contents of one MyDeque object to another, in the blocks it already has
+         * shares the blocks of a copy on write rhs instead, unless this MyDeque is bounded, and keeps
+         * its own blocks as the spares around them
+         * either way this MyDeque keeps its own bound, policy and modes
+         */
+        MyDeque& operator = (const MyDeque& rhs) {
+            if (this == &rhs) {
+                return *this;
+            }
+            if (rhs._cow && rhs._top && !_limit && _a == rhs._a && _p == rhs._p) {
+                share_over(rhs);
+                assert(valid());
+                return *this;
+            }
+
+            assign_n(rhs.begin(), rhs.size());
+            return *this;
+        }
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param index a size_type
+         * @return a reference
+         * gives the element a MyDeque contains at index, which must be less than size()
+         */
+        reference operator [] (size_type index) {
+            // <your code>
+            assert(index < size());
+            size_type g = (_b - _top[_u_top]) + index;
+            return own(_u_top + g / BLOCK_WIDTH)[g % BLOCK_WIDTH];
+        }
+
+        /**
+         * @param index a size_type
+         * @return a const_reference
+         * gives the element a MyDeque contains at index, which must be less than size()
+         */
+        const_reference operator [] (size_type index) const {
+            assert(index < size());
+            return unchecked_at(index);
+        }
+
+        // ------------
+        // acquire_back
+        // ------------
+
+        /**
+         * @param n a size_type
+         * @param v a pointer to room for m segments
+         * @param m a size_type
+         * @return the number of segments written to v
+         * @throws length_error if a bounded MyDeque can't hold n more elements
+         * makes room for n elements after the last one and describes it in v, front to back, as
+         * runs of raw storage that can be written to directly, in at most m runs
+         * the elements only join the MyDeque when commit_back is called
+         */
+        size_type acquire_back (size_type n, segment* v, size_type m) {
+            static_assert(std::is_trivially_copyable<T>::value, "acquire_back hands out raw storage");
+            if (_limit && size() + n > _limit) {
+                throw std::length_error("size exceeds the capacity of a bounded MyDeque");
+            }
+            if (!n || !m) {
+                return 0;
+            }
+            if (!_top) {
+                reserve_map(0, n / BLOCK_WIDTH);
+            }
+            else {
+                reserve_map(0, _u_top + ((_b - _top[_u_top]) + size() + n) / BLOCK_WIDTH - _u_bottom);
+            }
+            size_type g = _e - _top[_u_bottom];
+            size_type c = 0;
+            for (size_type k = _u_bottom; n && c != m; ++k) {
+                size_type l = std::min(n, BLOCK_WIDTH - g);
+                v[c].base   = own(k) + g;
+                v[c].length = l;
+                ++c;
+                n -= l;
+                g = 0;
+            }
+            return c;
+        }
+
+        // ------
+        // assign
+        // ------
+
+        /**
+         * @param n a size_type
+         * @param v a const_reference
+         * @throws length_error if a bounded MyDeque can't hold n elements
+         * replaces the contents of a MyDeque with n copies of v, reusing the blocks it has
+         */
+        void assign (size_type n, const_reference v) {
+            value_type x(v);
+            repeat r = {&x};
+            assign_n(r, n);
+        }
+
+        /**
+         * @param b a forward iterator
+         * @param e a forward iterator
+         * @throws length_error if a bounded MyDeque can't hold the elements of [b, e)
+         * replaces the contents of a MyDeque with the elements of [b, e), reusing the blocks it has
+         */
+        template <typename FI, typename = typename std::enable_if<!std::is_integral<FI>::value>::type>
+        void assign (FI b, FI e) {
+            assign_n(b, std::distance(b, e));
+        }
+
+        // --
+        // at
+        // --
+
+        /**
+         * @param index a size_type
+         * @return a reference
+         * @throws out_of_range if (index < 0) or (index >= size())
+         * gives the element a MyDeque contains at index
+         */
+        reference at (size_type index) {
+            if (index >= size()) {
+                throw std::out_of_range("ERROR: invalid index!");
+            }
+            return (*this)[index];
+        }
+
+        /**
+         * @param index a size_type
+         * @return a const_reference
+         * @throws out_of_range if (index < 0) or (index >= size())
+         * gives the element a MyDeque contains at index
+         */
+        const_reference at (size_type index) const {
+            if (index >= size()) {
+                throw std::out_of_range("ERROR: invalid index!");
+            }
+            return (*this)[index];
+        }
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @return a reference
+         * gives a reference to last element in the container
+         */
+        reference back () {
+            // <your code>
+            assert(!empty());
+            
+            return *(end() - 1);
+        }
+
+        /**
+         * @return a const_reference
+         * gives a const_reference to last element in the container
+         * reads the block in place, so a shared block is never cloned for a read
+         */
+        const_reference back () const {
+            assert(!empty());
+            return unchecked_at(size() - 1);
+        }
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return an iterator
+         * gives an iterator that points to the first element in a MyDeque
+         */
+        iterator begin () {
+            return iterator(this, _u_top, _top ? _b - _top[_u_top] : 0);
+        }
+
+        /**
+         * @return an const_iterator
+         * gives an const_iterator that points to the first element in a MyDeque
+         */
+        const_iterator begin () const {
+            return const_iterator(this, _u_top, _top ? _b - _top[_u_top] : 0);
+        }
+
+        // --------
+        // capacity
+        // --------
+
+        /**
+         * @return a size_type
+         * gives the most elements a bounded MyDeque holds, or 0 if it is unbounded
+         */
+        size_type capacity () const {
+            return _limit;
+        }
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * removes all elements from MyDeque
+         */
+        void clear () {
+            // <your code>
+            if (_top) {
+                drop(true);
+                set_end(0);
+            }
+            assert(valid());
+        }
+
+        // -----------
+        // commit_back
+        // -----------
+
+        /**
+         * @param k a size_type, at most what the last acquire_back made room for
+         * adds the first k elements of the storage from the last acquire_back to the end of a MyDeque
+         */
+        void commit_back (size_type k) {
+            static_assert(std::is_trivially_copyable<T>::value, "commit_back takes raw storage");
+            if (k) {
+                set_end(size() + k);
+            }
+            assert(valid());
+        }
+
+        // -------------
+        // consume_front
+        // -------------
+
+        /**
+         * @param k a size_type, at most size()
+         * removes the first k elements, typically after peek_front handed them to a write
+         */
+        void consume_front (size_type k) {
+            pop_front_n(k);
+        }
+
+        // -------------
+        // copy_on_write
+        // -------------
+
+        /**
+         * @return a bool
+         * checks if copies of a MyDeque share its blocks
+         */
+        bool copy_on_write () const {
+            return _cow;
+        }
+
+        /**
+         * @param on a bool
+         * makes copies of a MyDeque share its blocks, so a copy costs one outer container
+         * and a block is only cloned when one of the sharers writes to it
+         */
+        void copy_on_write (bool on) {
+            settle();
+            _cow = on;
+        }
+
+        // ----------------
+        // drain_front_into
+        // ----------------
+
+        /**
+         * @param x an output iterator
+         * @param n a size_type, at most size()
+         * @return x past the last element written
+         * moves the first n elements to x and removes them, a block at a time
+         * elements of blocks shared with another MyDeque are copied instead
+         */
+        template <typename OI>
+        OI drain_front_into (OI x, size_type n) {
+            assert(n <= size());
+            if (!n) {
+                return x;
+            }
+            size_type g = (_b - _top[_u_top]) + n;
+            for (size_type k = _u_top; k <= _u_top + (g - 1) / BLOCK_WIDTH; ++k) {
+                pointer b = (k == _u_top) ? _b : _top[k];
+                pointer e = _top[k] + std::min<size_type>(g - (k - _u_top) * BLOCK_WIDTH, BLOCK_WIDTH);
+                prefetch_block(k + prefetch_ahead);
+                if (shared(k)) {
+                    x = std::copy(b, e, x);
+                }
+                else {
+                    x = std::move(b, e, x);
+                }
+            }
+            pop_front_n(n);
+            return x;
+        }
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return a bool
+         * checks if a MyDeque is empty
+         */
+        bool empty () const {
+            return !_s;
+        }
+
+        // ----
+        // full
+        // ----
+
+        /**
+         * @return a bool
+         * checks if a bounded MyDeque holds as many elements as it can
+         */
+        bool full () const {
+            return _limit && size() == _limit;
+        }
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return an iterator
+         * gives an iterator that points to the last element in a MyDeque
+         */
+        iterator end () {
+            return iterator(this, _u_bottom, _top ? _e - _top[_u_bottom] : 0);
+        }
+
+        /**
+         * @return an const_iterator
+         * gives an const_iterator that points to the last element in a MyDeque
+         */
+        const_iterator end () const {
+            return const_iterator(this, _u_bottom, _top ? _e - _top[_u_bottom] : 0);
+        }
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * @param p an iterator
+         * @return an iterator
+         * removes an element from the MyDeque at position pointed to by p
+         */
+        iterator erase (iterator p) {
+            // <your code>
+            size_type d = p - begin();
+            if (p == end() - 1) {
+                pop_back();
+            }
+            else {
+                erase_at(d, is_trivially_relocatable<T>());
+            }
+            
+            assert(valid());
+            return begin() + d;
+        }
+
+        /**
+         * @param f an iterator
+         * @param l an iterator, not before f
+         * @return an iterator to the element that followed the last one removed
+         * removes [f, l) by moving whichever of the elements before f and the elements from l on
+         * are fewer over the gap, and releasing the blocks that leaves empty
+         */
+        iterator erase (iterator f, iterator l) {
+            size_type d = f - begin();
+            size_type n = l - f;
+            if (d < size() - d - n) {
+                std::move_backward(begin(), f, l);
+                pop_front_n(n);
+            }
+            else {
+                std::move(l, end(), f);
+                pop_back_n(n);
+            }
+            assert(valid());
+            return begin() + d;
+        }
+
+        // --------
+        // erase_if
+        // --------
+
+        /**
+         * @param p a unary predicate
+         * @return a size_type, the number of elements removed
+         * removes the elements p is true for in one stable pass, calling p once per element
+         * finds the first and the last element to remove, then compacts the survivors between
+         * them toward whichever end has fewer elements past it, so those are the ones moved
+         */
+        template <typename P>
+        size_type erase_if (P p) {
+            const MyDeque& c = *this;
+            size_type      n = size();
+            size_type      f = std::find_if(c.begin(), c.end(), p) - c.begin();
+            if (f == n) {
+                return 0;
+            }
+            size_type l = n - 1;
+            for (const_iterator q = c.end() - 1; l != f && !p(*q); --q) {
+                --l;
+            }
+            iterator m = begin() + f;
+            iterator r = begin() + l;
+            if (n - l - 1 <= f) {
+                iterator w = m;
+                if (l != f) {
+                    while (++m != r) {
+                        if (!p(*m)) {
+                            *w = std::move(*m);
+                            ++w;
+                        }
+                    }
+                }
+                w = std::move(r + 1, end(), w);
+                size_type k = end() - w;
+                pop_back_n(k);
+                return k;
+            }
+            iterator w = r + 1;
+            if (l != f) {
+                while (--r != m) {
+                    if (!p(*r)) {
+                        *--w = std::move(*r);
+                    }
+                }
+            }
+            w = std::move_backward(begin(), m, w);
+            size_type k = w - begin();
+            pop_front_n(k);
+            return k;
+        }
+
+        // ----------------
+        // for_each_segment
+        // ----------------
+
+        /**
+         * @param f a function taking a pointer to the first element of a run and one past its last
+         * @return f
+         * calls f on each run of elements that sit next to each other in one block, front to back
+         */
+        template <typename F>
+        F for_each_segment (F f) {
+            for (size_type k = _u_top; !empty() && k <= _u_bottom; ++k) {
+                pointer b = own(k);
+                pointer e = (k == _u_bottom) ? _e : b + BLOCK_WIDTH;
+                if (k == _u_top) {
+                    b = _b;
+                }
+                prefetch_block(k + prefetch_ahead);
+                if (b != e) {
+                    f(b, e);
+                }
+            }
+            return f;
+        }
+
+        /**
+         * @param f a function taking a const_pointer to the first element of a run and one past its last
+         * @return f
+         * calls f on each run of elements that sit next to each other in one block, front to back
+         */
+        template <typename F>
+        F for_each_segment (F f) const {
+            for (size_type k = _u_top; !empty() && k <= _u_bottom; ++k) {
+                const_pointer b = (k == _u_top)    ? _b : _top[k];
+                const_pointer e = (k == _u_bottom) ? _e : _top[k] + BLOCK_WIDTH;
+                prefetch_block(k + prefetch_ahead);
+                if (b != e) {
+                    f(b, e);
+                }
+            }
+            return f;
+        }
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return a reference
+         * gives a reference to the first element in a MyDeque container
+         */
+        reference front () {
+            // <your code>
+            assert(!empty());
+            return *begin();;
+        }
+
+        /**
+         * @return a const_reference
+         * gives a const_reference to the first element in a MyDeque container
+         * reads the block in place, so a shared block is never cloned for a read
+         */
+        const_reference front () const {
+            assert(!empty());
+            return *_b;
+        }
+
+        // --------------
+        // gradual_growth
+        // --------------
+
+        /**
+         * @return a bool
+         * checks if a MyDeque grows its outer container a few slots per push and pop
+         */
+        bool gradual_growth () const {
+            return _gradual;
+        }
+
+        /**
+         * @param on a bool
+         * makes a MyDeque whose outer container is crowded start a new one early and fill it in
+         * GROWTH_STEP slots per push and pop, so no single push or pop moves the whole outer
+         * container or allocates the blocks for its new slots
+         * a MyDeque that is bounded or shares blocks with a copy grows all at once as before
+         */
+        void gradual_growth (bool on) {
+            if (!on) {
+                settle();
+            }
+            _gradual = on;
+        }
+
+        // ------
+        // gather
+        // ------
+
+        /**
+         * @param b an input iterator over indices
+         * @param e an input iterator over indices
+         * @param x an output iterator
+         * @return an output iterator past the last element written
+         * copies the elements at each index in [b, e) to x, prefetching a few indices ahead
+         * so the cache misses of a random access pattern overlap
+         */
+        template <typename II, typename OI>
+        OI gather (II b, II e, OI x) const {
+            if (b == e) {
+                return x;
+            }
+            const size_type ahead = 8;
+            const size_type o = _b - _top[_u_top];
+            II p = b;
+            for (size_type k = 0; k != ahead && p != e; ++k, ++p) {
+                prefetch(o + *p);
+            }
+            while (b != e) {
+                if (p != e) {
+                    prefetch(o + *p);
+                    ++p;
+                }
+                *x = unchecked_at(*b);
+                ++x;
+                ++b;
+            }
+            return x;
+        }
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * @param p an iterator
+         * @param v a const_reference
+         * @return an iterator
+         * adds an element of value v to the MyDeque at position pointed to by p
+         * a full bounded MyDeque first drops its first element, or gives end() if it rejects
+         */
+        iterator insert (iterator p, const_reference v) {
+            // <your code>
+            difference_type d = p - begin();
+            if (full()) {
+                if (_policy == reject_newest) {
+                    return end();
+                }
+                value_type x(v);
+                pop_front();
+                return insert(begin() + (d ? d - 1 : 0), x);
+            }
+            if (p == end()) {
+                push_back(v);
+            }
+            else {
+                insert_at(d, v, is_trivially_relocatable<T>());
+            }
+
+            assert(valid());
+            return begin() + d;
+        }
+
+        // ----------
+        // peek_front
+        // ----------
+
+        /**
+         * @param v a pointer to room for m segments
+         * @param m a size_type
+         * @return the number of segments written to v
+         * describes the elements in v, front to back, as the runs they sit in, in at most m runs
+         */
+        size_type peek_front (const_segment* v, size_type m) const {
+            size_type c = 0;
+            for (size_type k = _u_top; !empty() && k <= _u_bottom && c != m; ++k) {
+                const_pointer b = (k == _u_top)    ? _b : _top[k];
+                const_pointer e = (k == _u_bottom) ? _e : _top[k] + BLOCK_WIDTH;
+                if (b != e) {
+                    v[c].base   = b;
+                    v[c].length = e - b;
+                    ++c;
+                }
+            }
+            return c;
+        }
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * removes the last element from a MyDeque
+         */
+        void pop_back () {
+            // <your code>
+            assert(!empty());
+            if (_g.map) {
+                grow_step(GROWTH_STEP);
+            }
+            if (_e == _top[_u_bottom]) {
+                --_u_bottom;
+                _e = _top[_u_bottom] + BLOCK_WIDTH;
+            }
+            own(_u_bottom);
+            --_e;
+            traits_type::destroy(_a, _e);
+            --_s;
+            assert(valid());
+        }
+
+        /**
+         * @param n a size_type, at most size()
+         * removes the last n elements from a MyDeque, a block at a time
+         */
+        void pop_back_n (size_type n) {
+            assert(n <= size());
+            if (!n) {
+                return;
+            }
+            size_type g = (_b - _top[_u_top]) + (size() - n);
+            size_type k = _u_top + g / BLOCK_WIDTH;
+            size_type l = (k == _u_bottom) ? _e - _top[k] : BLOCK_WIDTH;
+            for (size_type j = _u_bottom; j != k; --j) {
+                release(j, 0, (j == _u_bottom) ? _e - _top[j] : BLOCK_WIDTH);
+            }
+            if (g % BLOCK_WIDTH != l) {
+                pointer p = own(k);
+                destroy_run(p + g % BLOCK_WIDTH, p + l);
+            }
+            _u_bottom = k;
+            _e = _top[k] + g % BLOCK_WIDTH;
+            _s -= n;
+            assert(valid());
+        }
+
+        /**
+         * removes the first element from a MyDeque
+         */
+        void pop_front () {
+            //<your code>
+            assert(!empty());
+            if (_g.map) {
+                grow_step(GROWTH_STEP);
+            }
+            own(_u_top);
+            traits_type::destroy(_a, _b);
+            if (++_b == _top[_u_top] + BLOCK_WIDTH) {
+                ++_u_top;
+                _b = _top[_u_top];
+            }
+            --_s;
+
+            assert(valid());
+        }
+
+        /**
+         * @param n a size_type, at most size()
+         * removes the first n elements from a MyDeque, a block at a time
+         */
+        void pop_front_n (size_type n) {
+            assert(n <= size());
+            if (!n) {
+                return;
+            }
+            size_type g = (_b - _top[_u_top]) + n;
+            size_type k = _u_top + g / BLOCK_WIDTH;
+            size_type f = (k == _u_top) ? _b - _top[k] : 0;
+            for (size_type j = _u_top; j != k; ++j) {
+                release(j, (j == _u_top) ? _b - _top[j] : 0, BLOCK_WIDTH);
+            }
+            if (g % BLOCK_WIDTH != f) {
+                pointer p = own(k);
+                destroy_run(p + f, p + g % BLOCK_WIDTH);
+            }
+            _u_top = k;
+            _b = _top[k] + g % BLOCK_WIDTH;
+            _s -= n;
+            assert(valid());
+        }
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * @param v a const_reference
+         * @return a bool, false if a full bounded MyDeque rejected v
+         * adds an element of value v to the end of a MyDeque
+         * a full bounded MyDeque first drops its first element, or rejects v
+         */
+        bool push_back (const_reference v) {
+            // <your code>
+            return put_back(v);
+        }
+
+        /**
+         * @param v a value_type
+         * @return a bool, false if a full bounded MyDeque rejected v
+         * moves v onto the end of a MyDeque
+         */
+        bool push_back (value_type&& v) {
+            return put_back(std::move(v));
+        }
+
+        /**
+         * @param v a const_reference
+         * @return a bool, false if a full bounded MyDeque rejected v
+         * adds an element of value v to the beginning of a MyDeque
+         * a full bounded MyDeque first drops its last element, or rejects v
+         */
+        bool push_front (const_reference v) {
+            // <your code>
+            return put_front(v);
+        }
+
+        /**
+         * @param v a value_type
+         * @return a bool, false if a full bounded MyDeque rejected v
+         * moves v onto the beginning of a MyDeque
+         */
+        bool push_front (value_type&& v) {
+            return put_front(std::move(v));
+        }
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * @param s a size_type
+         * @param v a const_reference
+         * @throws length_error if a bounded MyDeque can't hold s elements
+         * resizes a MyDeque so it contains s elements
+         */
+        void resize (size_type s, const_reference v = value_type()) {
+            // <your code>
+            if (s == size()) {
+                return ;
+            }
+            if (_limit && s > _limit) {
+                throw std::length_error("size exceeds the capacity of a bounded MyDeque");
+            }
+
+            if ( s < size()) {
+                destroy(_a, begin() + s, end());
+                set_end(s);
+            }
+            else {
+                if (!_top) {
+                    reserve_map(0, s / BLOCK_WIDTH);
+                }
+                else {
+                    size_type last = _u_top + ((_b - _top[_u_top]) + s) / BLOCK_WIDTH;
+                    reserve_map(0, last - _u_bottom);
+                }
+                uninitialized_fill(_a, end(), begin() + s, v);
+                set_end(s);
+            }
+
+            assert(valid());
+        }
+
+        // -------------
+        // shared_blocks
+        // -------------
+
+        /**
+         * @return a size_type
+         * gives the number of blocks in use that are also owned by another MyDeque
+         */
+        size_type shared_blocks () const {
+            size_type n = 0;
+            if (_top) {
+                for (size_type k = _u_top; k <= _u_bottom; ++k) {
+                    n += shared(k);
+                }
+            }
+            return n;
+        }
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return a size_type
+         * gives current number of elements in a MyDeque
+         */
+        size_type size () const {
+            return _s;
+        }
+
+        // ----
+        // sort
+        // ----
+
+        /**
+         * @param c a binary predicate
+         * @param threads a size_type
+         * sorts a MyDeque by sorting each block in place, optionally on several threads,
+         * and then merging the blocks into a fresh set of blocks
+         */
+        template <typename C>
+        void sort (C c, size_type threads = 1) {
+            segment_sort(c, threads, false);
+        }
+
+        /**
+         * sorts a MyDeque into ascending order
+         */
+        void sort () {
+            sort(std::less<value_type>());
+        }
+
+        // -----------
+        // splice_back
+        // -----------
+
+        /**
+         * @param that a MyDeque rvalue reference
+         * @throws length_error if a bounded MyDeque that rejects the newest can't hold that too
+         * moves every element of that onto the end of a MyDeque, leaving that empty
+         * whole blocks change owner when the first free slot here lines up with the first element of that,
+         * otherwise the smaller side is moved element by element
+         */
+        void splice_back (MyDeque&& that) {
+            if (this == &that || that.empty()) {
+                return;
+            }
+            if (_limit && _policy == reject_newest && size() + that.size() > _limit) {
+                throw std::length_error("size exceeds the capacity of a bounded MyDeque");
+            }
+            detach();
+            that.detach();
+
+            if (!adoptable(that) || empty() || (_e - _top[_u_bottom]) != (that._b - that._top[that._u_top])) {
+                if (adoptable(that) && size() < that.size()) {
+                    while (!empty()) {
+                        that.put_front(std::move(back()));
+                        pop_back();
+                    }
+                    swap_storage(that);
+                }
+                else {
+                    while (!that.empty()) {
+                        put_back(std::move(that.front()));
+                        that.pop_front();
+                    }
+                }
+                assert(valid());
+                return;
+            }
+
+            while (!that.empty() && that._b != that._top[that._u_top]) {
+                put_back(std::move(that.front()));
+                that.pop_front();
+            }
+            // a push above may have started a gradual growth, which the new map would orphan
+            settle();
+            if (!that.empty()) {
+                // our last block is empty now, their blocks take its place
+                size_type n = that._u_bottom - that._u_top + 1;
+                size_type e = that._e - that._top[that._u_bottom];
+                size_type m = block_size + that.block_size;
+                p_pointer x = _p.allocate(m);
+                p_pointer y = std::copy(_top, _top + _u_bottom, x);
+                y = std::copy(that._top + that._u_top, that._top + that._u_bottom + 1, y);
+                y = std::copy(_top + _u_bottom, _bottom, y);
+                y = std::copy(that._top, that._top + that._u_top, y);
+                std::copy(that._top + that._u_bottom + 1, that._bottom, y);
+                _u_bottom += n - 1;
+                adopt_map(x, m);
+                _e = _top[_u_bottom] + e;
+                _s += that._s;
+                that.forget_map();
+            }
+            assert(valid());
+        }
 
-                /**
-                 * @param d a difference_type
-                 * @return an iterator reference
-                 * increments an iterator by d
-                 */
-                iterator& operator += (difference_type d) {
-                    if ( (&p->_top[i][j] - &p->_top[i][0]) + d > BLOCK_WIDTH ) {
-                        size_type block_jump = ( (&p->_top[i][j] - &p->_top[i][0]) + d) / BLOCK_WIDTH;
-                        i += block_jump;
-                        
-                        size_type temp = (BLOCK_WIDTH * ++block_jump) - d;
-                        j = BLOCK_WIDTH - temp;
+        // ------------
+        // splice_front
+        // ------------
+
+        /**
+         * @param that a MyDeque rvalue reference
+         * @throws length_error if a bounded MyDeque that rejects the newest can't hold that too
+         * moves every element of that onto the beginning of a MyDeque, leaving that empty
+         * whole blocks change owner when the first element here lines up with the end of that,
+         * otherwise the smaller side is moved element by element
+         */
+        void splice_front (MyDeque&& that) {
+            if (this == &that || that.empty()) {
+                return;
+            }
+            if (_limit && _policy == reject_newest && size() + that.size() > _limit) {
+                throw std::length_error("size exceeds the capacity of a bounded MyDeque");
+            }
+            detach();
+            that.detach();
+
+            if (!adoptable(that) || empty() || (_b - _top[_u_top]) != (that._e - that._top[that._u_bottom])) {
+                if (adoptable(that) && size() < that.size()) {
+                    while (!empty()) {
+                        that.put_back(std::move(front()));
+                        pop_front();
+                    }
+                    swap_storage(that);
+                }
+                else {
+                    while (!that.empty()) {
+                        put_front(std::move(that.back()));
+                        that.pop_back();
+                    }
+                }
+                assert(valid());
+                return;
+            }
+
+            while (!that.empty() && that._e != that._top[that._u_bottom]) {
+                put_front(std::move(that.back()));
+                that.pop_back();
+            }
+            // a push above may have started a gradual growth, which the new map would orphan
+            settle();
+            if (!that.empty()) {
+                // their last block is empty now, our blocks follow their full ones
+                size_type n = that._u_bottom - that._u_top;
+                size_type b = that._b - that._top[that._u_top];
+                size_type m = block_size + that.block_size;
+                p_pointer x = _p.allocate(m);
+                p_pointer y = std::copy(that._top, that._top + that._u_bottom, x);
+                y = std::copy(_top + _u_top, _top + _u_bottom + 1, y);
+                y = std::copy(that._top + that._u_bottom, that._bottom, y);
+                y = std::copy(_top, _top + _u_top, y);
+                std::copy(_top + _u_bottom + 1, _bottom, y);
+                _u_bottom = that._u_top + n + (_u_bottom - _u_top);
+                _u_top = that._u_top;
+                adopt_map(x, m);
+                _b = _top[_u_top] + b;
+                _s += that._s;
+                that.forget_map();
+            }
+            assert(valid());
+        }
+
+        // --------
+        // split_at
+        // --------
+
+        /**
+         * @param index a size_type
+         * @return a MyDeque holding the elements from index on, which are removed from this MyDeque
+         * hands every block after the one holding index to the new MyDeque and moves at most
+         * one block's worth of elements
+         */
+        MyDeque split_at (size_type index) {
+            assert(index <= size());
+            MyDeque r(_a);
+            if (index == size()) {
+                return r;
+            }
+            detach();
+            if (index == 0 && adoptable(r)) {
+                r.swap_storage(*this);
+                return r;
+            }
+            if (!adoptable(r)) {
+                for (iterator p = begin() + index; p != end(); ++p) {
+                    r.put_back(std::move(*p));
+                }
+                destroy(_a, begin() + index, end());
+                set_end(index);
+                return r;
+            }
+
+            size_type g = (_b - _top[_u_top]) + index;
+            size_type k = _u_top + g / BLOCK_WIDTH;
+            size_type s = g % BLOCK_WIDTH;
+            size_type n = _u_bottom - k;
+
+            // everything that can throw comes before either side changes
+            size_type m = block_size - n;
+            p_pointer t = r._p.allocate(n + 1);
+            pointer   h;
+            p_pointer y;
+            try {
+                h = _a.allocate(BLOCK_WIDTH);
+            }
+            catch (...) {
+                r._p.deallocate(t, n + 1);
+                throw;
+            }
+            try {
+                y = _p.allocate(m);
+            }
+            catch (...) {
+                _a.deallocate(h, BLOCK_WIDTH);
+                r._p.deallocate(t, n + 1);
+                throw;
+            }
+
+            r.block_size = n + 1;
+            r._top = t;
+            r._bottom = t + n + 1;
+            r._top[0] = h;
+            std::copy(_top + k + 1, _top + _u_bottom + 1, r._top + 1);
+            r._u_top = 0;
+            r._u_bottom = n;
+
+            pointer f = _top[k] + s;
+            pointer l = (k == _u_bottom) ? _e : _top[k] + BLOCK_WIDTH;
+            pointer x = r._top[0] + s;
+            relocate(x, f, l - f);
+            x += l - f;
+            r._b = r._top[0] + s;
+            r._e = n ? _e : x;
+            r._s = _s - index;
+
+            std::copy(_top, _top + k + 1, y);
+            std::copy(_top + _u_bottom + 1, _bottom, y + k + 1);
+            _p.deallocate(_top, block_size);
+            _top = y;
+            _bottom = y + m;
+            block_size = m;
+            _u_bottom = k;
+            _e = f;
+            _s = index;
+
+            assert(valid());
+            assert(r.valid());
+            return r;
+        }
+
+        // -----------
+        // stable_sort
+        // -----------
+
+        /**
+         * @param c a binary predicate
+         * @param threads a size_type
+         * sorts a MyDeque like sort, keeping equal elements in their original order
+         */
+        template <typename C>
+        void stable_sort (C c, size_type threads = 1) {
+            segment_sort(c, threads, true);
+        }
+
+        /**
+         * sorts a MyDeque into ascending order, keeping equal elements in their original order
+         */
+        void stable_sort () {
+            stable_sort(std::less<value_type>());
+        }
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param rhs a MyDeque reference
+         * Switches the contents of two MyDeque objects
+         */
+        void swap (MyDeque& rhs) {
+            // <your code>
+            if (_a == rhs._a && _p == rhs._p) {
+                swap_storage(rhs);
+                std::swap(_limit, rhs._limit);
+                std::swap(_policy, rhs._policy);
+                std::swap(_cow, rhs._cow);
+                std::swap(_gradual, rhs._gradual);
+            }
+            else {
+                MyDeque x(*this);
+                *this = rhs;
+                rhs = x;
+            }
+            
+            assert(valid());
+        }
+
+        // ------------
+        // unchecked_at
+        // ------------
+
+        /**
+         * @param index a size_type
+         * @return a reference
+         * gives the element a MyDeque contains at index without checking it, even in debug builds
+         */
+        reference unchecked_at (size_type index) {
+            size_type g = (_b - _top[_u_top]) + index;
+            return own(_u_top + g / BLOCK_WIDTH)[g % BLOCK_WIDTH];
+        }
+
+        /**
+         * @param index a size_type
+         * @return a const_reference
+         * gives the element a MyDeque contains at index without checking it, even in debug builds
+         */
+        const_reference unchecked_at (size_type index) const {
+            size_type g = (_b - _top[_u_top]) + index;
+            return _top[_u_top + g / BLOCK_WIDTH][g % BLOCK_WIDTH];
+        }
+};
+
+// -------------
+// MyDeque<bool>
+// -------------
+
+/**
+ * a MyDeque of flags, 64 to a word
+ *
+ * The words sit in a plain MyDeque, BLOCK_WIDTH of them to a block. The first flag is bit _b of
+ * the first word, and the bits around the flags are kept zero, so counting and searching go a
+ * word at a time with popcount and count trailing zeros. Like std::vector<bool>, elements are
+ * reached through a proxy reference and iterators that hold an index.
+ */
+template <typename A>
+class MyDeque<bool, A> {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                                   allocator_type;
+        typedef bool                                                value_type;
+
+        typedef typename allocator_type::size_type                  size_type;
+        typedef typename allocator_type::difference_type            difference_type;
+
+        typedef bool                                                const_reference;
+
+        typedef unsigned long long                                  word;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<word> w_allocator_type;
+
+    private:
+        typedef MyDeque<word, w_allocator_type>                     words_type;
+
+    public:
+        // ---------
+        // reference
+        // ---------
+
+        /**
+         * stands in for one flag: reads as a bool and assigns through to its bit
+         */
+        class reference {
+            friend class MyDeque;
+
+            private:
+                word* p;
+                word  m;
+
+                reference (word* x, word y) :
+                        p (x), m (y)
+                    {}
+
+            public:
+                operator bool () const {
+                    return (*p & m) != 0;
+                }
+
+                reference& operator = (bool v) {
+                    if (v) {
+                        *p |= m;
                     }
                     else {
-                        j += d;
+                        *p &= ~m;
                     }
-                    
-                    assert(valid());
                     return *this;
                 }
 
-                // -----------
-                // operator -=
-                // -----------
+                reference& operator = (const reference& that) {
+                    return *this = static_cast<bool>(that);
+                }
 
                 /**
-                 * @param d a difference_type
-                 * @return an iterator reference
-                 * decrements an iterator by d
+                 * turns the flag over
+                 */
+                void flip () {
+                    *p ^= m;
+                }
+        };
+
+        // --------
+        // iterator
+        // --------
+
+        /**
+         * a random access iterator over the flags by index, dereferencing to a reference
+         */
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::random_access_iterator_tag   iterator_category;
+                typedef bool                              value_type;
+                typedef typename MyDeque::difference_type difference_type;
+                typedef void                              pointer;
+                typedef typename MyDeque::reference       reference;
+
+            public:
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return lhs.i == rhs.i;
+                }
+
+                friend bool operator != (const iterator& lhs, const iterator& rhs) {
+                    return lhs.i != rhs.i;
+                }
+
+                friend bool operator < (const iterator& lhs, const iterator& rhs) {
+                    return lhs.i < rhs.i;
+                }
+
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;
+                }
+
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;
+                }
+
+                friend difference_type operator - (const iterator& lhs, const iterator& rhs) {
+                    return lhs.i - rhs.i;
+                }
+
+            private:
+                // ----
+                // data
+                // ----
+
+                MyDeque*        p;
+                difference_type i;
+
+                friend class const_iterator;
+
+            public:
+                /**
+                 * @param x a MyDeque pointer
+                 * @param y a difference_type
+                 * @return a new iterator pointing to flag y of x
                  */
+                iterator (MyDeque* x, difference_type y) :
+                        p (x), i (y)
+                    {}
+
+                reference operator * () const {
+                    return (*p)[i];
+                }
+
+                reference operator [] (difference_type d) const {
+                    return (*p)[i + d];
+                }
+
+                iterator& operator ++ () {
+                    ++i;
+                    return *this;
+                }
+
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++i;
+                    return x;
+                }
+
+                iterator& operator -- () {
+                    --i;
+                    return *this;
+                }
+
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --i;
+                    return x;
+                }
+
+                iterator& operator += (difference_type d) {
+                    i += d;
+                    return *this;
+                }
+
                 iterator& operator -= (difference_type d) {
-                    if ( (&p->_top[i][j] - &p->_top[i][0]) - d < 0 ) {
-                        size_type block_jump = ( (&p->_top[i][j] - &p->_top[i][0]) - d) / BLOCK_WIDTH;
-                        i += block_jump;
-                        j = BLOCK_WIDTH * -block_jump - d + 1;
-                    }
-                    else {
-                        j -= d;
-                    }
-                    
-                    assert(valid());
-                    return *this;}
+                    i -= d;
+                    return *this;
+                }
         };
 
-    public:
         // --------------
         // const_iterator
         // --------------
 
+        /**
+         * a random access iterator over the flags by index, dereferencing to a bool
+         */
         class const_iterator {
             public:
                 // --------
                 // typedefs
                 // --------
 
-                typedef std::bidirectional_iterator_tag   iterator_category;
-                typedef typename MyDeque::value_type      value_type;
+                typedef std::random_access_iterator_tag   iterator_category;
+                typedef bool                              value_type;
                 typedef typename MyDeque::difference_type difference_type;
-                typedef typename MyDeque::const_pointer   pointer;
-                typedef typename MyDeque::const_reference reference;
+                typedef void                              pointer;
+                typedef bool                              reference;
 
             public:
-                // -----------
-                // operator ==
-                // -----------
-
-                /**
-                 * @param lhs a const_iterator reference
-                 * @param rhs a const_iterator reference
-                 * @return a bool
-                 * checks to see if two const_iterators are equal to each other
-                 */
                 friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
-                    return lhs.i == rhs.i && lhs.j == rhs.j;
+                    return lhs.i == rhs.i;
                 }
 
-                /**
-                 * @param lhs a const_iterator reference
-                 * @param rhs a const_iterator reference
-                 * @return a bool
-                 * checks to see if two const_iterators are not equal to each other
-                 */
                 friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
-                    return !(lhs == rhs);
+                    return lhs.i != rhs.i;
                 }
 
-                // ----------
-                // operator +
-                // ----------
+                friend bool operator < (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.i < rhs.i;
+                }
 
-                /**
-                 * @param lhs a const_iterator
-                 * @param rhs a difference_type
-                 * @return a const_iterator
-                 * increments a const_iterator by rhs
-                 */
                 friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
                     return lhs += rhs;
                 }
 
-                // ----------
-                // operator -
-                // ----------
-
-                /**
-                 * @param lhs a const_iterator
-                 * @param rhs a difference_type
-                 * @return a const_iterator
-                 * decrements a const_iterator by rhs
-                 */
                 friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
                     return lhs -= rhs;
                 }
 
+                friend difference_type operator - (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.i - rhs.i;
+                }
+
             private:
                 // ----
                 // data
                 // ----
 
                 const MyDeque*  p;
-                size_type i;
-                size_type j;
-
-            private:
-                // -----
-                // valid
-                // -----
-
-                bool valid () const {
-                    return i >= 0 && j >= 0;
-                    return true;
-                }
+                difference_type i;
 
             public:
-                // -----------
-                // constructor
-                // -----------
-
                 /**
                  * @param x a MyDeque pointer
-                 * @param y a size_type
-                 * @param z a size_type
-                 * @return a new const_iterator
-                 * constructs a new const_iterator pointing to an element's address
+                 * @param y a difference_type
+                 * @return a new const_iterator pointing to flag y of x
                  */
-                const_iterator (const MyDeque* x, size_type y, size_type z) : p(x) {
-                    i = y;
-                    j = z;
-                    assert(valid());
-                }
-
-                // Default copy, destructor, and copy assignment.
-                // const_iterator (const const_iterator&);
-                // ~const_iterator ();
-                // const_iterator& operator = (const const_iterator&);
-
-                // ----------
-                // operator *
-                // ----------
+                const_iterator (const MyDeque* x, difference_type y) :
+                        p (x), i (y)
+                    {}
 
                 /**
-                 * @return a reference to the element being pointed to
-                 * dereferences a const_iterator to access its data
+                 * @param that an iterator
+                 * @return a new const_iterator pointing where that points
                  */
+                const_iterator (const iterator& that) :
+                        p (that.p), i (that.i)
+                    {}
+
                 reference operator * () const {
-                    return p->_top[i][j];
+                    return (*p)[i];
                 }
 
-                // -----------
-                // operator ->
-                // -----------
-
-                /**
-                 * @return a pointer to an element
-                 * gives the address a const_iterator points to
-                 */
-                pointer operator -> () const {
-                    return &**this;
+                reference operator [] (difference_type d) const {
+                    return (*p)[i + d];
                 }
 
-                // -----------
-                // operator ++
-                // -----------
-
-                /**
-                 * @return a const_iterator reference
-                 * increments a const_iterator by one
-                 */
                 const_iterator& operator ++ () {
-                    if (&p->_top[i][j] == &p->_top[i][BLOCK_WIDTH - 1]) {
-                        ++i;
-                        j = 0;
-                    }
-                    else {
-                        ++j;
-                    }
-                    
-                    assert(valid());
+                    ++i;
                     return *this;
                 }
 
-                /**
-                 * @return a const_iterator
-                 * gives a copy of a const_iterator and increments the original by one
-                 */
                 const_iterator operator ++ (int) {
                     const_iterator x = *this;
-                    ++(*this);
-                    assert(valid());
+                    ++i;
                     return x;
                 }
 
-                // -----------
-                // operator --
-                // -----------
-
-                /**
-                 * @return a const_iterator reference
-                 * decrements a const_iterator by one
-                 */
                 const_iterator& operator -- () {
-                    if (&p->_top[i][j] == &p->_top[i][0]) {
-                        --i;
-                        j = BLOCK_WIDTH;
-                    }
-                    else {
-                        --j;
-                    }
-                    
-                    assert(valid());
+                    --i;
                     return *this;
                 }
 
-                /**
-                 * @return a const_iterator
-                 * gives a copy of a const_iterator and decrements the original by one
-                 */
                 const_iterator operator -- (int) {
                     const_iterator x = *this;
-                    --(*this);
-                    assert(valid());
+                    --i;
                     return x;
                 }
 
-                // -----------
-                // operator +=
-                // -----------
-
-                /**
-                 * @param d a difference_type
-                 * @return a const_iterator reference
-                 * increments a const_iterator by d
-                 */
                 const_iterator& operator += (difference_type d) {
-                    if ( (&p->_top[i][j] - &p->_top[i][0]) + d > BLOCK_WIDTH ) {
-                        size_type block_jump = ( (&p->_top[i][j] - &p->_top[i][0]) + d) / BLOCK_WIDTH;
-                        i += block_jump;
-                        j = BLOCK_WIDTH * block_jump - d;
-                    }
-                    else {
-                        j += d;
-                    }
-                    
-                    assert(valid());
+                    i += d;
                     return *this;
                 }
 
-                // -----------
-                // operator -=
-                // -----------
-
-                /**
-                 * @param d a difference_type
-                 * @return a const_iterator reference
-                 * decrements a const_iterator by d
-                 */
                 const_iterator& operator -= (difference_type d) {
-                    if ( (&p->_top[i][j] - &p->_top[i][0]) - d < 0 ) {
-                        size_type block_jump = ( (&p->_top[i][j] - &p->_top[i][0]) - d) / BLOCK_WIDTH;
-                        i += block_jump;
-                        j = BLOCK_WIDTH * -block_jump - d + 1;
-                    }
-                    else {
-                        j -= d;
-                    }
-                    
-                    assert(valid());
+                    i -= d;
                     return *this;
                 }
         };
 
     public:
-        // ------------
-        // constructors
-        // ------------
+        // -----------
+        // operator ==
+        // -----------
 
         /**
-         * @param a an allocator_type reference
-         * @return a MyDeque object
-         * makes a new MyDeque object from an allocator_type
+         * @param lhs a MyDeque reference
+         * @param rhs a MyDeque reference
+         * @return a bool
+         * checks if two MyDeque objects hold the same flags
          */
-        explicit MyDeque (const allocator_type& a = allocator_type()) :
-                _a (a), _p () {
-            _top = _bottom = 0;
-            _b = _e = 0;
-            block_size = _u_top = _u_bottom = 0;
-            
-            assert(valid());
+        friend bool operator == (const MyDeque& lhs, const MyDeque& rhs) {
+            return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());
         }
 
+        // ----------
+        // operator <
+        // ----------
+
         /**
-         * @param s a size_type
-         * @param v a const_reference
-         * @param a an allocator_type reference
-         * @return a MyDeque object
-         * makes a new MyDeque object of size s and fills it with value v
+         * @param lhs a MyDeque reference
+         * @param rhs a MyDeque reference
+         * @return a bool
+         * checks if a MyDeque object is less than the other
          */
-        explicit MyDeque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
-                _a (a), _p () {
+        friend bool operator < (const MyDeque& lhs, const MyDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
 
-            size_type num_blocks = s / BLOCK_WIDTH;
-            if (s % BLOCK_WIDTH) {
-                ++num_blocks;
-            }
-            block_size = num_blocks;
+    private:
+        // ----
+        // data
+        // ----
 
-            _top = _p.allocate(num_blocks);
-            _bottom = _top + num_blocks;
-            
-            p_pointer temp = _top;
-            while (_top != _bottom) {
-                *_top = _a.allocate(BLOCK_WIDTH);
-                ++_top;
-            }
-            _top = temp;
-            
-            _b = _top[0];
+        words_type _w;
+        size_type  _b;      // bit of the first word holding the first flag
+        size_type  _s;      // number of flags
 
-            size_type remainder = BLOCK_WIDTH;
-            if (s % BLOCK_WIDTH != 0) {
-                remainder -= BLOCK_WIDTH * num_blocks - s;
-            }
-            _e = _top[num_blocks - 1] + remainder;
-            
-            _u_top = 0;
-            _u_bottom = num_blocks - 1;
-            
-            uninitialized_fill(_a, begin(), end(), v);
-            
-            assert(valid());
-        }
+    private:
+        // -----
+        // valid
+        // -----
 
-        /**
-         * @param that a MyDeque reference
-         * @return a MyDeque object
-         * makes a new MyDeque object with the contents of another MyDeque object
-         */
-        MyDeque (const MyDeque& that) :
-                _a (that._a), _p (that._p) {
-            _top = _p.allocate(that.block_size);
-            _bottom = _top + that.block_size;
-                        
-            block_size = that.block_size;
-                        
-            p_pointer temp = _top;
-            while (_top != _bottom) {
-                *_top = _a.allocate(BLOCK_WIDTH);
-                ++_top;
-            }
-            _top = temp;
+        bool valid () const {
+            return (_b < 64) && (_w.size() == (_b + _s + 63) / 64) && (_s || !_b);
+        }
 
-            _u_top = that._u_top;
-            _u_bottom = that._u_bottom;
-            
-            _b = _top[_u_top] + (that._b - that._top[that._u_top]);
-            _e = _top[_u_bottom] + (that._e - that._top[that._u_bottom]);
-            
-            uninitialized_copy(_a, that.begin(), that.end(), begin());
-                    
-            assert(valid());
+        // ----------
+        // count_bits
+        // ----------
+
+        static size_type count_bits (word x) {
+#ifdef __GNUC__
+            return __builtin_popcountll(x);
+#else
+            size_type c = 0;
+            for (; x; x &= x - 1) {
+                ++c;
+            }
+            return c;
+#endif
         }
 
         // ----------
-        // destructor
+        // lowest_bit
         // ----------
 
         /**
-         * destroys a MyDeque object
+         * @param x a word, not 0
+         * @return the position of the lowest bit set in x
          */
-        ~MyDeque () {
-            if (_top) {
-                clear();
-                
-                p_pointer temp = _top;
-                while (_top != _bottom) {
-                    _a.deallocate(*_top, BLOCK_WIDTH);
-                    ++_top;
-                }
-                _top = temp;
-                
-                _p.deallocate(_top, block_size);
+        static size_type lowest_bit (word x) {
+#ifdef __GNUC__
+            return __builtin_ctzll(x);
+#else
+            size_type c = 0;
+            for (; !(x & 1); x >>= 1) {
+                ++c;
             }
-            
-            assert(valid());
+            return c;
+#endif
         }
 
-        // ----------
-        // operator =
-        // ----------
+        // --------
+        // low_bits
+        // --------
 
         /**
-         * @param rhs a MyDeque reference
-         * @return a MyDeque reference
-         * assigns the contents of one MyDeque object to another
+         * @param n a size_type, at most 64
+         * @return a word with its lowest n bits set
          */
-        MyDeque& operator = (const MyDeque& rhs) {
-            if (this == &rhs) {
-                return *this;
-            }
+        static word low_bits (size_type n) {
+            return (n < 64) ? (word(1) << n) - 1 : ~word(0);
+        }
 
-            size_type capacity = block_size * BLOCK_WIDTH;
-            if (rhs.size() == size()) {
-                std::copy(rhs.begin(), rhs.end(), begin());
+        // -------
+        // or_bits
+        // -------
+
+        /**
+         * @param g a size_type, a bit counted from the bottom of the first word
+         * @param x a word holding n bits
+         * @param n a size_type, at most 64
+         * sets the bits of x in the n bits starting at g, which must exist
+         */
+        void or_bits (size_type g, word x, size_type n) {
+            _w[g / 64] |= x << (g % 64);
+            if (g % 64 + n > 64) {
+                _w[g / 64 + 1] |= x >> (64 - g % 64);
             }
-            else if (rhs.size() < size()) {
-                std::copy(rhs.begin(), rhs.end(), begin());
-                resize(rhs.size());
+        }
+
+        // ----
+        // trim
+        // ----
+
+        /**
+         * drops the words past the last flag, and every word once there are no flags
+         */
+        void trim () {
+            if (!_s) {
+                _w.clear();
+                _b = 0;
+                return;
             }
-            else if (rhs.size() <= capacity) {
-                if (block_size ==1) {
-                    resize(rhs.size());
-                    std::copy(rhs.begin(), rhs.begin(), begin());
+            _w.pop_back_n(_w.size() - (_b + _s + 63) / 64);
+        }
+
+        // -------
+        // counter
+        // -------
 
-                } else {
-                    std::copy(rhs.begin(), rhs.begin() + size() + 2, begin());
-                    _e = &*uninitialized_copy(_a, rhs.begin() + size() + 2, rhs.end(), end());
+        struct counter {
+            size_type c;
+
+            counter () :
+                    c (0)
+                {}
+
+            void operator () (const word* b, const word* e) {
+                while (b != e) {
+                    c += count_bits(*b);
+                    ++b;
                 }
             }
-            else {   
-                resize(rhs.size());
-                std::copy(rhs.begin(), rhs.end(), begin());
-            }
-            
-            assert(valid());
-            return *this;
+        };
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param a an allocator_type
+         */
+        explicit MyDeque (const allocator_type& a = allocator_type()) :
+                _w (w_allocator_type(a)), _b (0), _s (0)
+            {}
+
+        /**
+         * @param s a size_type
+         * @param v a bool
+         * @param a an allocator_type
+         * makes a MyDeque of s flags, each v
+         */
+        explicit MyDeque (size_type s, bool v = false, const allocator_type& a = allocator_type()) :
+                _w (w_allocator_type(a)), _b (0), _s (0) {
+            resize(s, v);
         }
 
+        // Default copy, destructor, and copy assignment.
+
         // -----------
         // operator []
         // -----------
 
         /**
-         * @param index a size_type
-         * @return a reference
-         * gives the element a MyDeque contains at index
+         * @param index a size_type, less than size()
+         * @return a reference to the flag at index
          */
         reference operator [] (size_type index) {
-            // <your code>
-            if (index == 0) {
-                return *_b;
-            }
-            
-            reference result = *_b;
-            if (index >= size()) {
-                throw std::out_of_range("index value exceeds bounds");
-            }
-
-
-            if ((_b - _top[_u_top]) + index > BLOCK_WIDTH) {
-                size_type block_jump = ((_b - _top[_u_top]) + index) / BLOCK_WIDTH;
-                pointer temp = _top[_u_top + block_jump];
-                result = *(temp + (_b - _top[_u_top]) + index % BLOCK_WIDTH);                 
-            }
-             else if (index ==  BLOCK_WIDTH) {
-                 result = * (_b+ BLOCK_WIDTH-1);
-             }
-            else {
-                 result = * (_b + index);
-            }
-            return result;
+            assert(index < size());
+            size_type g = _b + index;
+            return reference(&_w[g / 64], word(1) << (g % 64));
         }
 
         /**
-         * @param index a size_type
-         * @return a const_reference
-         * gives the element a MyDeque contains at index
+         * @param index a size_type, less than size()
+         * @return the flag at index
          */
         const_reference operator [] (size_type index) const {
-            return const_cast<MyDeque*>(this)->operator[](index);
+            assert(index < size());
+            size_type g = _b + index;
+            return (_w[g / 64] >> (g % 64)) & 1;
         }
 
         // --
@@ -867,79 +3974,61 @@ class MyDeque {
 
         /**
          * @param index a size_type
-         * @return a reference
-         * @throws out_of_range if (index < 0) or (index >= size())
-         * gives the element a MyDeque contains at index
+         * @return a reference to the flag at index
+         * @throws out_of_range if index isn't less than size()
          */
         reference at (size_type index) {
-            if ( (index < 0) || (index >= size()) ) {
-                throw std::out_of_range("ERROR: invalid index!");
+            if (index >= size()) {
+                throw std::out_of_range("MyDeque<bool>::at index out of range");
             }
             return (*this)[index];
         }
 
         /**
          * @param index a size_type
-         * @return a const_reference
-         * gives the element a MyDeque contains at index
+         * @return the flag at index
+         * @throws out_of_range if index isn't less than size()
          */
         const_reference at (size_type index) const {
-            return const_cast<MyDeque*>(this)->at(index);
+            if (index >= size()) {
+                throw std::out_of_range("MyDeque<bool>::at index out of range");
+            }
+            return (*this)[index];
         }
 
         // ----
         // back
         // ----
 
-        /**
-         * @return a reference
-         * gives a reference to last element in the container
-         */
         reference back () {
-            // <your code>
             assert(!empty());
-            
-            return *(end() - 1);
+            return (*this)[size() - 1];
         }
 
-        /**
-         * @return a const_reference
-         * gives a const_reference to last element in the container
-         */
         const_reference back () const {
-            return const_cast<MyDeque*>(this)->back();
+            assert(!empty());
+            return (*this)[size() - 1];
         }
 
         // -----
         // begin
         // -----
 
-        /**
-         * @return an iterator
-         * gives an iterator that points to the first element in a MyDeque
-         */
         iterator begin () {
-            return iterator(this, _u_top, _b - _top[_u_top]);
+            return iterator(this, 0);
         }
 
-        /**
-         * @return an const_iterator
-         * gives an const_iterator that points to the first element in a MyDeque
-         */
         const_iterator begin () const {
-            return const_iterator(this, _u_top, _b - _top[_u_top]);
+            return const_iterator(this, 0);
         }
 
         // -----
         // clear
         // -----
 
-        /**
-         * removes all elements from MyDeque
-         */
         void clear () {
-            // <your code>
-            resize(0);
+            _s = 0;
+            trim();
             assert(valid());
         }
 
@@ -947,139 +4036,127 @@ class MyDeque {
         // empty
         // -----
 
-        /**
-         * @return a bool
-         * checks if a MyDeque is empty
-         */
         bool empty () const {
-            return !size();
+            return !_s;
         }
 
         // ---
         // end
         // ---
 
-        /**
-         * @return an iterator
-         * gives an iterator that points to the last element in a MyDeque
-         */
         iterator end () {
-            return iterator(this, _u_bottom, _e - _top[_u_bottom]);
+            return iterator(this, size());
         }
 
-        /**
-         * @return an const_iterator
-         * gives an const_iterator that points to the last element in a MyDeque
-         */
         const_iterator end () const {
-            return const_iterator(this, _u_bottom, _e - _top[_u_bottom]);
+            return const_iterator(this, size());
         }
 
-        // -----
-        // erase
-        // -----
+        // ----------
+        // find_first
+        // ----------
 
         /**
-         * @param p an iterator
-         * @return an iterator
-         * removes an element from the MyDeque at position pointed to by p
+         * @param from a size_type
+         * @return the index of the first set flag at or after from, or size() if there is none
          */
-        iterator erase (iterator p) {
-            // <your code>
-            if (p == end() - 1) {
-                pop_back();
+        size_type find_first (size_type from = 0) const {
+            if (from >= size()) {
+                return size();
             }
-            else {
-                std::copy(p + 1, end(), p);
-                resize(size() - 1);
+            size_type g = _b + from;
+            size_type k = g / 64;
+            size_type l = (_b + _s - 1) / 64;
+            typename words_type::const_iterator p = _w.begin() + k;
+            word x = *p & ~low_bits(g % 64);
+            while (!x && k != l) {
+                ++k;
+                ++p;
+                x = *p;
             }
-            
-            assert(valid());
-            return iterator(p);
+            return x ? k * 64 + lowest_bit(x) - _b : size();
         }
 
         // -----
         // front
         // -----
 
-        /**
-         * @return a reference
-         * gives a reference to the first element in a MyDeque container
-         */
         reference front () {
-            // <your code>
             assert(!empty());
-            return *begin();;
+            return (*this)[0];
         }
 
-        /**
-         * @return a const_reference
-         * gives a const_reference to the first element in a MyDeque container
-         */
         const_reference front () const {
-            return const_cast<MyDeque*>(this)->front();
+            assert(!empty());
+            return (*this)[0];
         }
 
-        // ------
-        // insert
-        // ------
+        // ---
+        // pop
+        // ---
 
         /**
-         * @param p an iterator
-         * @param v a const_reference
-         * @return an iterator
-         * adds an element of value v to the MyDeque at position pointed to by p
+         * removes the last flag
          */
-        iterator insert (iterator p, const_reference v) {
-            // <your code>
-            if (p == end()) {
-                push_back(v);
-            }
-            else {
-                resize(size()+1);
-		std::copy(p, end(), p+1);
-		*p = v;
-            }
-            
+        void pop_back () {
+            assert(!empty());
+            size_type g = _b + _s - 1;
+            _w[g / 64] &= ~(word(1) << (g % 64));
+            --_s;
+            trim();
             assert(valid());
-            return iterator(p);
         }
 
-        // ---
-        // pop
-        // ---
-
         /**
-         * removes the last element from a MyDeque
+         * removes the first flag
          */
-        void pop_back () {
-            // <your code>
+        void pop_front () {
             assert(!empty());
-            if (size() == 1) {
-                clear();
-            }
-            else {
-                resize(size() - 1);
+            _w[0] &= ~(word(1) << _b);
+            --_s;
+            if (++_b == 64) {
+                _w.pop_front();
+                _b = 0;
             }
+            trim();
             assert(valid());
         }
 
+        // --------
+        // popcount
+        // --------
+
+        /**
+         * @return the number of set flags
+         * counts whole words, a block of them at a time
+         */
+        size_type popcount () const {
+            return _w.for_each_segment(counter()).c;
+        }
+
         /**
-         * removes the first element from a MyDeque
+         * @param first a size_type
+         * @param last a size_type, with first <= last <= size()
+         * @return the number of set flags at indices [first, last)
          */
-        void pop_front () {
-            //<your code>
-            destroy(_a, begin(), begin() + 1);
-            
-            if (_b - _top[_u_top] ==  BLOCK_WIDTH) {
-                ++_u_top;
-                _b = _top[_u_top];
+        size_type popcount (size_type first, size_type last) const {
+            assert(first <= last && last <= size());
+            if (first == last) {
+                return 0;
             }
-            else {
-                ++_b;
+            size_type g = _b + first;
+            size_type h = _b + last;
+            size_type k = g / 64;
+            size_type l = (h - 1) / 64;
+            typename words_type::const_iterator p = _w.begin() + k;
+            if (k == l) {
+                return count_bits(*p & low_bits(h - k * 64) & ~low_bits(g % 64));
             }
-            
-            assert(valid());
+            size_type c = count_bits(*p & ~low_bits(g % 64));
+            for (++p, ++k; k != l; ++p, ++k) {
+                c += count_bits(*p);
+            }
+            return c + count_bits(*p & low_bits(h - l * 64));
         }
 
         // ----
@@ -1087,44 +4164,57 @@ class MyDeque {
         // ----
 
         /**
-         * @param v a const_reference
-         * adds an element of value v to the end of a MyDeque
+         * @param v a bool
+         * adds a flag after the last one
          */
-        void push_back (const_reference v) {
-            // <your code>
-            if (size() != 0) {
-                MyDeque copy(size() + 1, 0);
-                std::copy(begin(), end(), copy.begin());
-                std::fill(copy.begin() + size(), copy.end(), v);
-                swap(copy);
+        void push_back (bool v) {
+            push_back_bits(v, 1);
+        }
+
+        /**
+         * @param v a bool
+         * adds a flag before the first one
+         */
+        void push_front (bool v) {
+            push_front_bits(v, 1);
+        }
+
+        /**
+         * @param x a word
+         * @param n a size_type, at most 64
+         * adds the low n bits of x after the last flag, bit 0 first
+         */
+        void push_back_bits (word x, size_type n = 64) {
+            assert(n <= 64);
+            if (!n) {
+                return;
             }
-            else {
-                resize(size() + 1, v);
-                assert(valid());
+            size_type g = _b + _s;
+            if (_w.size() * 64 < g + n) {
+                _w.push_back(0);
             }
+            or_bits(g, x & low_bits(n), n);
+            _s += n;
+            assert(valid());
         }
 
         /**
-         * @param v a const_reference
-         * adds an element of value v to the beginning of a MyDeque
+         * @param x a word
+         * @param n a size_type, at most 64
+         * adds the low n bits of x before the first flag, so bit 0 of x becomes the first flag
          */
-        void push_front (const_reference v) {
-            // <your code>
-            if (size() == 0) {
-                MyDeque copy(size() + 1, v);
-                swap(copy);
+        void push_front_bits (word x, size_type n = 64) {
+            assert(n <= 64);
+            if (!n) {
+                return;
             }
-            else if (_top[_u_top] == _b) {
-                MyDeque copy(size() + 1, 0);
-                std::copy(begin(), end(), copy.begin() + 1);
-                std::fill(copy.begin(), copy.begin() + 1, v);
-                swap(copy);
-            }
-            else {
-                --_b;
-                _a.construct(&*begin(), v);
+            if (_b < n) {
+                _w.push_front(0);
+                _b += 64;
             }
-            
+            _b -= n;
+            or_bits(_b, x & low_bits(n), n);
+            _s += n;
             assert(valid());
         }
 
@@ -1134,37 +4224,21 @@ class MyDeque {
 
         /**
          * @param s a size_type
-         * @param v a const_reference
-         * resizes a MyDeque so it contains s elements
+         * @param v a bool
+         * resizes a MyDeque so it holds s flags, adding copies of v
          */
-        void resize (size_type s, const_reference v = value_type()) {
-            // <your code>
-            if (s == size()) {
-                return ;
-            }
-
-            size_type capacity = block_size * BLOCK_WIDTH;
-            if ( s < size()) {
-                _e = &*destroy(_a, begin() + s, end());
-                if (s > BLOCK_WIDTH) {
-                    _u_bottom = ( (s - BLOCK_WIDTH) / BLOCK_WIDTH ) + 1;
-                }
-                else {
-                    _u_bottom = (BLOCK_WIDTH - s) / BLOCK_WIDTH;
-                }
+        void resize (size_type s, bool v = false) {
+            while (_s < s) {
+                push_back_bits(v ? ~word(0) : 0, std::min<size_type>(64, s - _s));
             }
-            else if (s <= capacity) {
-                _e = &*uninitialized_fill(_a, end(), begin() + s, v);
-            }
-            else {
-                size_type capacity = std::max(2 * size(), s);                
-                MyDeque copy(capacity, v);
-                if (size() != 0) {
-                    std::copy(begin(), end(), copy.begin());
+            if (_s > s) {
+                size_type g = _b + s;
+                _s = s;
+                trim();
+                if (_s && g % 64) {
+                    _w[g / 64] &= low_bits(g % 64);
                 }
-                swap(copy);
             }
-            
             assert(valid());
         }
 
@@ -1172,62 +4246,18 @@ class MyDeque {
         // size
         // ----
 
-        /**
-         * @return a size_type
-         * gives current number of elements in a MyDeque
-         */
-        size_type size () const {            
-            if (_b == _e) {
-                return 0;
-            }
-            
-            size_type i = (_e - _top[_u_bottom]);
-            if (_u_top == _u_bottom) {
-                i = _e - _b;
-            }
-            
-            size_type between = 0;
-            if (_u_bottom - _u_top > 1) {
-                between = (_u_bottom - _u_top - 1) * BLOCK_WIDTH;
-            }
-
-            size_type j = 0;
-            if (_u_bottom - _u_top != 0) {
-                j = BLOCK_WIDTH - (_b - _top[_u_top]);
-            }    
-            
-            size_type result = i + j + between;
-            return result;
-            
-//            return _e - _b;
+        size_type size () const {
+            return _s;
         }
 
         // ----
         // swap
         // ----
 
-        /**
-         * @param rhs a MyDeque reference
-         * Switches the contents of two MyDeque objects
-         */
         void swap (MyDeque& rhs) {
-            // <your code>
-            if (_a == rhs._a && _p == rhs._p) {
-                std::swap(_top, rhs._top);
-                std::swap(_bottom, rhs._bottom);
-                std::swap(_u_top, rhs._u_top);
-                std::swap(_u_bottom, rhs._u_bottom);
-                std::swap(block_size, rhs.block_size);
-                std::swap(_b, rhs._b);
-                std::swap(_e, rhs._e);
-            }
-            else {
-                MyDeque x(*this);
-                *this = rhs;
-                rhs = x;
-            }
-            
-            assert(valid());
+            _w.swap(rhs._w);
+            std::swap(_b, rhs._b);
+            std::swap(_s, rhs._s);
         }
 };
 
@@ -0,0 +1,354 @@
+// -----------------------------------
+// projects/deque/HugePageAllocator.h
+// -----------------------------------
+
+#ifndef HugePageAllocator_h
+#define HugePageAllocator_h
+
+// --------
+// includes
+// --------
+
+#include <cstddef>  // ptrdiff_t, size_t
+#include <memory>   // shared_ptr
+#include <mutex>    // lock_guard, mutex
+#include <new>      // bad_alloc
+#include <utility>  // forward
+#include <vector>   // vector
+
+#ifdef __linux__
+#include <sys/mman.h>    // madvise, mmap, munmap
+#include <sys/syscall.h> // SYS_getcpu, SYS_mbind
+#include <unistd.h>      // syscall
+#endif
+
+// ---------------
+// huge_page_arena
+// ---------------
+
+/**
+ * hands out memory carved from 2 MiB regions, each asked to be backed by one transparent huge page
+ *
+ * Requests are rounded up to a multiple of 16 bytes and recycled through a free list per size, so
+ * the equal sized blocks of a MyDeque end up packed side by side in a few regions instead of being
+ * scattered over the heap. Requests bigger than a quarter of a region, like the outer container,
+ * get their own mapping. Regions go back to the system only when the arena dies.
+ * When bind is set each region is also bound to the NUMA node of the thread that maps it.
+ * Either hint failing, or the platform lacking them, just leaves ordinary pages.
+ */
+class huge_page_arena {
+    public:
+        // ---------
+        // constants
+        // ---------
+
+        static const std::size_t region_size = 2 << 20;
+        static const std::size_t granule     = 16;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        std::mutex          _m;
+        bool                _bind;
+        std::vector<char*>  _regions;
+        std::vector<void*>  _free;      // head of the free list for each multiple of granule
+        char*               _next;      // unused part of the newest region
+        char*               _end;
+        std::size_t         _hinted;    // regions the kernel took the huge page hint for
+
+    private:
+        // ---
+        // map
+        // ---
+
+        /**
+         * @param n a size_t, a multiple of region_size
+         * @param hint a bool
+         * @return a pointer to n bytes aligned to region_size
+         */
+        char* map (std::size_t n, bool hint) {
+#ifdef __linux__
+            // over-map by a region so the start can be aligned, then give the slack back
+            std::size_t m = n + (hint ? region_size : 0);
+            void* v = mmap(0, m, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (v == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            char* p = static_cast<char*>(v);
+            if (hint) {
+                char* a = reinterpret_cast<char*>((reinterpret_cast<std::size_t>(p) + region_size - 1) & ~(region_size - 1));
+                if (a != p) {
+                    munmap(p, a - p);
+                }
+                if (a + n != p + m) {
+                    munmap(a + n, (p + m) - (a + n));
+                }
+                p = a;
+#ifdef MADV_HUGEPAGE
+                if (!madvise(p, n, MADV_HUGEPAGE)) {
+                    ++_hinted;
+                }
+#endif
+                if (_bind) {
+                    bind(p, n);
+                }
+            }
+            return p;
+#else
+            (void) hint;
+            return static_cast<char*>(::operator new(n));
+#endif
+        }
+
+        // -----
+        // unmap
+        // -----
+
+        void unmap (char* p, std::size_t n) {
+#ifdef __linux__
+            munmap(p, n);
+#else
+            (void) n;
+            ::operator delete(p);
+#endif
+        }
+
+        // ----
+        // bind
+        // ----
+
+        /**
+         * @param p a pointer to mapped memory
+         * @param n a size_t
+         * asks the kernel to place [p, p + n) on the NUMA node this thread runs on
+         */
+        static void bind (char* p, std::size_t n) {
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_getcpu)
+            unsigned cpu  = 0;
+            unsigned node = 0;
+            if (syscall(SYS_getcpu, &cpu, &node, 0) || node >= 8 * sizeof(unsigned long)) {
+                return;
+            }
+            const int     preferred = 1;   // MPOL_PREFERRED, from <numaif.h>
+            unsigned long mask      = 1UL << node;
+            syscall(SYS_mbind, p, n, preferred, &mask, 8 * sizeof(mask), 0);
+#else
+            (void) p;
+            (void) n;
+#endif
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param bind a bool, whether to bind regions to the NUMA node of the mapping thread
+         */
+        explicit huge_page_arena (bool bind = false) :
+                _bind (bind), _next (0), _end (0), _hinted (0)
+            {}
+
+        huge_page_arena (const huge_page_arena&) = delete;
+        huge_page_arena& operator = (const huge_page_arena&) = delete;
+
+        // ----------
+        // destructor
+        // ----------
+
+        ~huge_page_arena () {
+            for (std::size_t k = 0; k != _regions.size(); ++k) {
+                unmap(_regions[k], region_size);
+            }
+        }
+
+        // --------
+        // allocate
+        // --------
+
+        /**
+         * @param n a size_t
+         * @return a pointer to n bytes aligned to granule
+         */
+        void* allocate (std::size_t n) {
+            std::size_t c = n ? (n + granule - 1) / granule : 1;
+            if (c * granule > region_size / 4) {
+                return map((c * granule + region_size - 1) / region_size * region_size, false);
+            }
+            std::lock_guard<std::mutex> g(_m);
+            if (c < _free.size() && _free[c]) {
+                void* p = _free[c];
+                _free[c] = *static_cast<void**>(p);
+                return p;
+            }
+            if (_end - _next < static_cast<std::ptrdiff_t>(c * granule)) {
+                // room first, so nothing throws between mapping the region and keeping it
+                _regions.reserve(_regions.size() + 1);
+                _regions.push_back(map(region_size, true));
+                _next = _regions.back();
+                _end = _next + region_size;
+            }
+            void* p = _next;
+            _next += c * granule;
+            return p;
+        }
+
+        // ----------
+        // deallocate
+        // ----------
+
+        /**
+         * @param p a pointer from allocate
+         * @param n a size_t, the size it was allocated with
+         */
+        void deallocate (void* p, std::size_t n) {
+            std::size_t c = n ? (n + granule - 1) / granule : 1;
+            if (c * granule > region_size / 4) {
+                unmap(static_cast<char*>(p), (c * granule + region_size - 1) / region_size * region_size);
+                return;
+            }
+            std::lock_guard<std::mutex> g(_m);
+            if (c >= _free.size()) {
+                _free.resize(c + 1, 0);
+            }
+            *static_cast<void**>(p) = _free[c];
+            _free[c] = p;
+        }
+
+        // -----
+        // stats
+        // -----
+
+        /**
+         * @return the number of regions mapped
+         */
+        std::size_t regions () const {
+            return _regions.size();
+        }
+
+        /**
+         * @return the number of regions the kernel accepted the huge page hint for
+         */
+        std::size_t hinted () const {
+            return _hinted;
+        }
+};
+
+// -------------------
+// huge_page_allocator
+// -------------------
+
+/**
+ * an allocator drawing from a shared huge_page_arena
+ * copies and rebinds share the arena and compare equal, so MyDeque's outer container and
+ * bookkeeping come from the same arena as its blocks
+ */
+template <typename T>
+class huge_page_allocator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T              value_type;
+        typedef std::size_t    size_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T*             pointer;
+        typedef const T*       const_pointer;
+        typedef T&             reference;
+        typedef const T&       const_reference;
+
+        template <typename U>
+        struct rebind {
+            typedef huge_page_allocator<U> other;
+        };
+
+    public:
+        friend bool operator == (const huge_page_allocator& lhs, const huge_page_allocator& rhs) {
+            return lhs._arena == rhs._arena;
+        }
+
+        friend bool operator != (const huge_page_allocator& lhs, const huge_page_allocator& rhs) {
+            return !(lhs == rhs);
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        std::shared_ptr<huge_page_arena> _arena;
+
+        template <typename U>
+        friend class huge_page_allocator;
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param bind a bool, whether to bind regions to the NUMA node of the mapping thread
+         * makes an allocator with an arena of its own
+         */
+        explicit huge_page_allocator (bool bind = false) :
+                _arena (std::make_shared<huge_page_arena>(bind))
+            {}
+
+        template <typename U>
+        huge_page_allocator (const huge_page_allocator<U>& that) :
+                _arena (that._arena)
+            {}
+
+        // Default copy, destructor, and copy assignment.
+
+        // --------
+        // allocate
+        // --------
+
+        pointer allocate (size_type n) {
+            return static_cast<pointer>(_arena->allocate(n * sizeof(T)));
+        }
+
+        // ----------
+        // deallocate
+        // ----------
+
+        void deallocate (pointer p, size_type n) {
+            _arena->deallocate(p, n * sizeof(T));
+        }
+
+        // ---------
+        // construct
+        // ---------
+
+        template <typename U, typename... Args>
+        void construct (U* p, Args&&... args) {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        // -------
+        // destroy
+        // -------
+
+        template <typename U>
+        void destroy (U* p) {
+            p->~U();
+        }
+
+        // -----
+        // arena
+        // -----
+
+        /**
+         * @return the arena this allocator draws from
+         */
+        const huge_page_arena& arena () const {
+            return *_arena;
+        }
+};
+
+#endif // HugePageAllocator_h
@@ -0,0 +1,662 @@
+// -----------------------------
+// projects/deque/PackedDeque.h
+// -----------------------------
+
+#ifndef PackedDeque_h
+#define PackedDeque_h
+
+// --------
+// includes
+// --------
+
+#include <algorithm>   // fill
+#include <cassert>     // assert
+#include <cstddef>     // ptrdiff_t, size_t
+#include <iterator>    // random_access_iterator_tag
+#include <memory>      // allocator, allocator_traits
+#include <type_traits> // is_integral, is_same, make_unsigned
+
+#include "Deque.h"
+
+// -------------
+// MyPackedDeque
+// -------------
+
+/**
+ * a deque of integers, like sequence numbers or timestamps, that packs the blocks in its middle
+ *
+ * The first and last hot elements sit in two plain MyDeques, so pushes and pops at the ends cost
+ * what they cost there. Whole blocks of BLOCK_WIDTH elements that drift further in are packed into
+ * frames: the first value, then the gaps between neighbors, zigzag encoded so small negative gaps
+ * stay small, all stored in the fewest bits that hold the largest gap. Frames sit back to back in
+ * a MyDeque of words. Reading an element in a frame decodes the whole frame into a small cache,
+ * so a pass over the middle decodes each frame once. A frame is unpacked again when a pop reaches
+ * it. Elements are read by value; only the ends can change.
+ */
+template < typename T, typename A = std::allocator<T> >
+class MyPackedDeque {
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "MyPackedDeque holds integers");
+
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                        allocator_type;
+        typedef typename allocator_type::value_type      value_type;
+
+        typedef typename allocator_type::size_type       size_type;
+        typedef typename allocator_type::difference_type difference_type;
+
+    private:
+        typedef typename std::make_unsigned<T>::type     unsigned_type;
+        typedef unsigned long long                       word;
+
+        typedef typename std::allocator_traits<A>::template rebind_alloc<word>      w_allocator_type;
+        typedef typename std::allocator_traits<A>::template rebind_alloc<size_type> o_allocator_type;
+
+        static const size_type   bits       = 8 * sizeof(T);
+        static const size_type   frame_max  = 2 + (8 + (BLOCK_WIDTH - 1) * 64) / 64;
+        static const size_type   cache_size = 4;
+
+        /**
+         * a decoded frame, f is the id of the frame it holds
+         * an empty entry holds an id that can't map to it, see invalidate
+         */
+        struct entry {
+            size_type f;
+            T         v[BLOCK_WIDTH];
+        };
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs a MyPackedDeque reference
+         * @param rhs a MyPackedDeque reference
+         * @return a bool
+         * checks if two MyPackedDeque objects hold the same elements
+         */
+        friend bool operator == (const MyPackedDeque& lhs, const MyPackedDeque& rhs) {
+            if (lhs.size() != rhs.size()) {
+                return false;
+            }
+            for (size_type i = 0; i != lhs.size(); ++i) {
+                if (lhs[i] != rhs[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        MyDeque<T, A>                         _head;  // the first elements, unpacked
+        MyDeque<T, A>                         _tail;  // the last elements, unpacked
+        MyDeque<word, w_allocator_type>       _w;     // packed frames, back to back
+        MyDeque<size_type, o_allocator_type>  _o;     // where each frame starts, counted like _w0
+        size_type                             _w0;    // position of _w[0], moves back on pushes at the front
+        size_type                             _f0;    // id of the first frame
+        size_type                             _hot;   // elements each end keeps unpacked
+        mutable entry                         _c[cache_size];
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return _o.empty() || (_head.size() <= _hot + BLOCK_WIDTH && _tail.size() <= _hot + BLOCK_WIDTH);
+        }
+
+        // ---
+        // put
+        // ---
+
+        /**
+         * @param x zeroed words
+         * @param b a size_type, the bit to write at, advanced past what is written
+         * @param v a word, less than 2 to the n
+         * @param n a size_type, at most 64
+         */
+        static void put (word* x, size_type& b, word v, size_type n) {
+            if (!n) {
+                return;
+            }
+            x[b / 64] |= v << (b % 64);
+            if (b % 64 + n > 64) {
+                x[b / 64 + 1] |= v >> (64 - b % 64);
+            }
+            b += n;
+        }
+
+        // ---
+        // get
+        // ---
+
+        /**
+         * @param x words
+         * @param b a size_type, the bit to read at, advanced past what is read
+         * @param n a size_type, at most 64
+         * @return the n bits at b
+         */
+        static word get (const word* x, size_type& b, size_type n) {
+            if (!n) {
+                return 0;
+            }
+            word v = x[b / 64] >> (b % 64);
+            if (b % 64 + n > 64) {
+                v |= x[b / 64 + 1] << (64 - b % 64);
+            }
+            if (n < 64) {
+                v &= (word(1) << n) - 1;
+            }
+            b += n;
+            return v;
+        }
+
+        // ------
+        // encode
+        // ------
+
+        /**
+         * @param v BLOCK_WIDTH values
+         * @param x room for frame_max words
+         * @return the number of words of the frame written to x
+         */
+        static size_type encode (const T* v, word* x) {
+            word z[BLOCK_WIDTH];
+            word m = 0;
+            for (size_type i = 1; i != BLOCK_WIDTH; ++i) {
+                unsigned_type d = static_cast<unsigned_type>(v[i]) - static_cast<unsigned_type>(v[i - 1]);
+                z[i] = static_cast<unsigned_type>((d << 1) ^ (0 - (d >> (bits - 1))));
+                m |= z[i];
+            }
+            size_type w = 0;
+            while (w != 64 && (m >> w)) {
+                ++w;
+            }
+            size_type n = 1 + (8 + (BLOCK_WIDTH - 1) * w + 63) / 64;
+            std::fill(x, x + n, word(0));
+            x[0] = static_cast<unsigned_type>(v[0]);
+            size_type b = 0;
+            put(x + 1, b, w, 8);
+            for (size_type i = 1; i != BLOCK_WIDTH; ++i) {
+                put(x + 1, b, z[i], w);
+            }
+            return n;
+        }
+
+        // ------
+        // decode
+        // ------
+
+        /**
+         * @param x the words of a frame
+         * @param v room for BLOCK_WIDTH values
+         */
+        static void decode (const word* x, T* v) {
+            v[0] = static_cast<T>(static_cast<unsigned_type>(x[0]));
+            size_type b = 0;
+            size_type w = get(x + 1, b, 8);
+            for (size_type i = 1; i != BLOCK_WIDTH; ++i) {
+                word          z = get(x + 1, b, w);
+                unsigned_type d = static_cast<unsigned_type>((z >> 1) ^ (0 - (z & 1)));
+                v[i] = static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(v[i - 1]) + d));
+            }
+        }
+
+        // ------
+        // length
+        // ------
+
+        /**
+         * @param k a size_type
+         * @return the number of words in frame k
+         */
+        size_type length (size_type k) const {
+            size_type l = (k + 1 != _o.size()) ? _o[k + 1] - _w0 : _w.size();
+            return l - (_o[k] - _w0);
+        }
+
+        // -----
+        // frame
+        // -----
+
+        /**
+         * @param k a size_type
+         * @return the values of frame k, decoded into the cache if they aren't there already
+         */
+        const T* frame (size_type k) const {
+            entry& e = _c[(_f0 + k) % cache_size];
+            if (e.f != _f0 + k) {
+                word      x[frame_max];
+                size_type s = _o[k] - _w0;
+                size_type n = length(k);
+                for (size_type j = 0; j != n; ++j) {
+                    x[j] = _w[s + j];
+                }
+                decode(x, e.v);
+                e.f = _f0 + k;
+            }
+            return e.v;
+        }
+
+        // ----------
+        // invalidate
+        // ----------
+
+        /**
+         * @param f a size_type, the id of a frame that was removed or reused
+         * empties its cache entry by giving it id f + 1, which maps to another entry
+         */
+        void invalidate (size_type f) {
+            entry& e = _c[f % cache_size];
+            if (e.f == f) {
+                e.f = f + 1;
+            }
+        }
+
+        // ---------
+        // pack_back
+        // ---------
+
+        /**
+         * moves the first block of the tail into a frame after the last, once the tail is long enough
+         * while there are no frames and the head is short of hot, the block joins the head instead
+         */
+        void pack_back () {
+            if (_tail.size() < _hot + BLOCK_WIDTH) {
+                return;
+            }
+            T v[BLOCK_WIDTH];
+            _tail.drain_front_into(v, BLOCK_WIDTH);
+            if (_o.empty() && _head.size() < _hot) {
+                for (size_type i = 0; i != BLOCK_WIDTH; ++i) {
+                    _head.push_back(v[i]);
+                }
+                return;
+            }
+            word      x[frame_max];
+            size_type n = encode(v, x);
+            _o.push_back(_w0 + _w.size());
+            for (size_type j = 0; j != n; ++j) {
+                _w.push_back(x[j]);
+            }
+            invalidate(_f0 + _o.size() - 1);
+        }
+
+        // ----------
+        // pack_front
+        // ----------
+
+        /**
+         * moves the last block of the head into a frame before the first, once the head is long enough
+         * while there are no frames and the tail is short of hot, the block joins the tail instead
+         */
+        void pack_front () {
+            if (_head.size() < _hot + BLOCK_WIDTH) {
+                return;
+            }
+            T         v[BLOCK_WIDTH];
+            size_type s = _head.size() - BLOCK_WIDTH;
+            for (size_type i = 0; i != BLOCK_WIDTH; ++i) {
+                v[i] = _head[s + i];
+            }
+            _head.pop_back_n(BLOCK_WIDTH);
+            if (_o.empty() && _tail.size() < _hot) {
+                for (size_type i = BLOCK_WIDTH; i != 0; --i) {
+                    _tail.push_front(v[i - 1]);
+                }
+                return;
+            }
+            word      x[frame_max];
+            size_type n = encode(v, x);
+            for (size_type j = n; j != 0; --j) {
+                _w.push_front(x[j - 1]);
+            }
+            _w0 -= n;
+            _o.push_front(_w0);
+            --_f0;
+            invalidate(_f0);
+        }
+
+        // -----------
+        // unpack_back
+        // -----------
+
+        /**
+         * moves the last frame, decoded, into the empty tail
+         */
+        void unpack_back () {
+            size_type k = _o.size() - 1;
+            const T*  v = frame(k);
+            for (size_type i = 0; i != BLOCK_WIDTH; ++i) {
+                _tail.push_back(v[i]);
+            }
+            _w.pop_back_n(length(k));
+            _o.pop_back();
+            invalidate(_f0 + k);
+        }
+
+        // ------------
+        // unpack_front
+        // ------------
+
+        /**
+         * moves the first frame, decoded, into the empty head
+         */
+        void unpack_front () {
+            const T*  v = frame(0);
+            for (size_type i = 0; i != BLOCK_WIDTH; ++i) {
+                _head.push_back(v[i]);
+            }
+            size_type n = length(0);
+            _w.pop_front_n(n);
+            _w0 += n;
+            _o.pop_front();
+            invalidate(_f0);
+            ++_f0;
+        }
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        /**
+         * a random access iterator over the elements by index, giving them by value
+         */
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::random_access_iterator_tag        iterator_category;
+                typedef typename MyPackedDeque::value_type      value_type;
+                typedef typename MyPackedDeque::difference_type difference_type;
+                typedef const value_type*                       pointer;
+                typedef value_type                              reference;
+
+            public:
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.i == rhs.i;
+                }
+
+                friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.i != rhs.i;
+                }
+
+                friend bool operator < (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.i < rhs.i;
+                }
+
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;
+                }
+
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;
+                }
+
+                friend difference_type operator - (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.i - rhs.i;
+                }
+
+            private:
+                // ----
+                // data
+                // ----
+
+                const MyPackedDeque* p;
+                difference_type      i;
+
+            public:
+                /**
+                 * @param x a MyPackedDeque pointer
+                 * @param y a difference_type
+                 * @return a new const_iterator pointing to element y of x
+                 */
+                const_iterator (const MyPackedDeque* x, difference_type y) :
+                        p (x), i (y)
+                    {}
+
+                reference operator * () const {
+                    return (*p)[i];
+                }
+
+                reference operator [] (difference_type d) const {
+                    return (*p)[i + d];
+                }
+
+                const_iterator& operator ++ () {
+                    ++i;
+                    return *this;
+                }
+
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++i;
+                    return x;
+                }
+
+                const_iterator& operator -- () {
+                    --i;
+                    return *this;
+                }
+
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --i;
+                    return x;
+                }
+
+                const_iterator& operator += (difference_type d) {
+                    i += d;
+                    return *this;
+                }
+
+                const_iterator& operator -= (difference_type d) {
+                    i -= d;
+                    return *this;
+                }
+        };
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param hot a size_type, the blocks each end keeps unpacked
+         * @param a an allocator_type
+         */
+        explicit MyPackedDeque (size_type hot = 4, const allocator_type& a = allocator_type()) :
+                _head (a), _tail (a), _w (a), _o (a), _w0 (0), _f0 (0), _hot (hot * BLOCK_WIDTH) {
+            for (size_type k = 0; k != cache_size; ++k) {
+                _c[k].f = k + 1;
+            }
+        }
+
+        // Default copy, destructor, and copy assignment.
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param index a size_type, less than size()
+         * @return the element at index
+         */
+        value_type operator [] (size_type index) const {
+            assert(index < size());
+            if (index < _head.size()) {
+                return _head[index];
+            }
+            index -= _head.size();
+            if (index < _o.size() * BLOCK_WIDTH) {
+                return frame(index / BLOCK_WIDTH)[index % BLOCK_WIDTH];
+            }
+            return _tail[index - _o.size() * BLOCK_WIDTH];
+        }
+
+        // ----
+        // back
+        // ----
+
+        value_type back () const {
+            assert(!empty());
+            return (*this)[size() - 1];
+        }
+
+        // -----
+        // begin
+        // -----
+
+        const_iterator begin () const {
+            return const_iterator(this, 0);
+        }
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * removes every element
+         */
+        void clear () {
+            _head.clear();
+            _tail.clear();
+            _w.clear();
+            _o.clear();
+            _w0 = _f0 = 0;
+            for (size_type k = 0; k != cache_size; ++k) {
+                _c[k].f = k + 1;
+            }
+        }
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return !size();
+        }
+
+        // ---
+        // end
+        // ---
+
+        const_iterator end () const {
+            return const_iterator(this, size());
+        }
+
+        // ---------
+        // footprint
+        // ---------
+
+        /**
+         * @return the bytes taken by the elements, packed or not, leaving out block and map overhead
+         */
+        size_type footprint () const {
+            return (_head.size() + _tail.size()) * sizeof(T) + _w.size() * sizeof(word) + _o.size() * sizeof(size_type);
+        }
+
+        // -----
+        // front
+        // -----
+
+        value_type front () const {
+            assert(!empty());
+            return (*this)[0];
+        }
+
+        // ------
+        // frames
+        // ------
+
+        /**
+         * @return the number of packed frames
+         */
+        size_type frames () const {
+            return _o.size();
+        }
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * removes the last element
+         */
+        void pop_back () {
+            assert(!empty());
+            if (_tail.empty() && !_o.empty()) {
+                unpack_back();
+            }
+            if (_tail.empty()) {
+                _head.pop_back();
+            }
+            else {
+                _tail.pop_back();
+            }
+            assert(valid());
+        }
+
+        /**
+         * removes the first element
+         */
+        void pop_front () {
+            assert(!empty());
+            if (_head.empty() && !_o.empty()) {
+                unpack_front();
+            }
+            if (_head.empty()) {
+                _tail.pop_front();
+            }
+            else {
+                _head.pop_front();
+            }
+            assert(valid());
+        }
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * @param v a value_type
+         * adds v after the last element
+         */
+        void push_back (value_type v) {
+            _tail.push_back(v);
+            pack_back();
+            assert(valid());
+        }
+
+        /**
+         * @param v a value_type
+         * adds v before the first element
+         */
+        void push_front (value_type v) {
+            _head.push_front(v);
+            pack_front();
+            assert(valid());
+        }
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _head.size() + _o.size() * BLOCK_WIDTH + _tail.size();
+        }
+};
+
+#endif // PackedDeque_h
@@ -0,0 +1,353 @@
+// ------------------------------
+// projects/deque/SlidingWindow.h
+// ------------------------------
+
+#ifndef SlidingWindow_h
+#define SlidingWindow_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>   // assert
+#include <memory>    // allocator_traits
+#include <utility>   // pair
+
+#include "Deque.h"
+
+// ----------
+// window_min
+// ----------
+
+template <typename T>
+struct window_min {
+    T operator () (const T& lhs, const T& rhs) const {
+        return (rhs < lhs) ? rhs : lhs;
+    }
+};
+
+// ----------
+// window_max
+// ----------
+
+template <typename T>
+struct window_max {
+    T operator () (const T& lhs, const T& rhs) const {
+        return (lhs < rhs) ? rhs : lhs;
+    }
+};
+
+// ---------------
+// MySlidingWindow
+// ---------------
+
+/**
+ * keeps the aggregate under an associative operation Op of the values pushed in the last
+ * stretch of time, in amortized O(1) per push, expiry and query
+ *
+ * The entries live in a single MyDeque split into two stacks: the first _f entries carry the
+ * aggregate of themselves through entry _f - 1, the rest are folded into _back as they arrive.
+ * When the front stack runs out the back one is flipped over, so every entry is aggregated a
+ * constant number of times. Op does not need to be commutative or to have an identity.
+ */
+template < typename T, typename Op, typename K = long long, typename A = std::allocator<T> >
+class MySlidingWindow {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef T         value_type;
+        typedef K         key_type;
+        typedef Op        operation_type;
+
+        struct entry {
+            T value;
+            K key;
+            T agg;
+
+            entry (const T& v, const K& k) :
+                    value (v), key (k), agg (v)
+                {}
+        };
+
+        typedef typename std::allocator_traits<A>::template rebind_alloc<entry> entry_allocator_type;
+        typedef MyDeque<entry, entry_allocator_type>                            container_type;
+        typedef typename container_type::size_type                              size_type;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        container_type _x;
+        size_type      _f;      // entries in the front stack
+        T              _back;   // aggregate of the back stack, if it isn't empty
+        Op             _op;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return _f <= _x.size();
+        }
+
+        // ----
+        // flip
+        // ----
+
+        /**
+         * turns the whole back stack into the front stack
+         */
+        void flip () {
+            _f = _x.size();
+            if (!_f) {
+                return;
+            }
+            typename container_type::iterator b = _x.begin();
+            typename container_type::iterator e = _x.end();
+            --e;
+            e->agg = e->value;
+            while (e != b) {
+                const T& a = e->agg;
+                --e;
+                e->agg = _op(e->value, a);
+            }
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param op an operation_type
+         * @return a MySlidingWindow object
+         * makes an empty MySlidingWindow aggregating with op
+         */
+        explicit MySlidingWindow (const Op& op = Op()) :
+                _x (), _f (0), _back (), _op (op) {
+            assert(valid());
+        }
+
+        // Default copy, destructor, and copy assignment.
+        // MySlidingWindow (const MySlidingWindow&);
+        // ~MySlidingWindow ();
+        // MySlidingWindow& operator = (const MySlidingWindow&);
+
+        // ---------
+        // aggregate
+        // ---------
+
+        /**
+         * @return a value_type
+         * gives the aggregate of every value in the window, oldest first
+         */
+        T aggregate () const {
+            assert(!empty());
+            if (_f == 0) {
+                return _back;
+            }
+            if (_f == _x.size()) {
+                return _x.front().agg;
+            }
+            return _op(_x.front().agg, _back);
+        }
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return a bool
+         * checks if the window holds no values
+         */
+        bool empty () const {
+            return _x.empty();
+        }
+
+        // -------------
+        // expire_before
+        // -------------
+
+        /**
+         * @param k a key_type
+         * @return a size_type
+         * drops every value whose key is less than k and gives how many were dropped
+         */
+        size_type expire_before (const K& k) {
+            size_type n = 0;
+            while (!_x.empty() && _x.front().key < k) {
+                pop();
+                ++n;
+            }
+            return n;
+        }
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return an entry reference
+         * gives the oldest entry in the window
+         */
+        const entry& front () const {
+            return _x.front();
+        }
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @return an entry reference
+         * gives the newest entry in the window
+         */
+        const entry& back () const {
+            return _x.back();
+        }
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * removes the oldest value from the window
+         */
+        void pop () {
+            assert(!empty());
+            if (_f == 0) {
+                flip();
+            }
+            _x.pop_front();
+            --_f;
+            assert(valid());
+        }
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * @param v a const_reference
+         * @param k a key_type, no less than the key of any value already in the window
+         * adds v to the window
+         */
+        void push (const T& v, const K& k) {
+            _back = (_f == _x.size()) ? v : _op(_back, v);
+            _x.push_back(entry(v, k));
+            assert(valid());
+        }
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return a size_type
+         * gives the number of values in the window
+         */
+        size_type size () const {
+            return _x.size();
+        }
+};
+
+// ----------------
+// window_min_max
+// ----------------
+
+template <typename T>
+struct window_min_max {
+    std::pair<T, T> operator () (const std::pair<T, T>& lhs, const std::pair<T, T>& rhs) const {
+        return std::pair<T, T>((rhs.first  < lhs.first)  ? rhs.first  : lhs.first,
+                               (lhs.second < rhs.second) ? rhs.second : lhs.second);
+    }
+};
+
+// ---------------
+// MySlidingMinMax
+// ---------------
+
+/**
+ * a MySlidingWindow that keeps both the smallest and the largest value in the window
+ */
+template < typename T, typename K = long long, typename A = std::allocator<T> >
+class MySlidingMinMax {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef MySlidingWindow<std::pair<T, T>, window_min_max<T>, K, A> window_type;
+        typedef typename window_type::size_type                         size_type;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        window_type _w;
+
+    public:
+        /**
+         * @return a bool
+         * checks if the window holds no values
+         */
+        bool empty () const {
+            return _w.empty();
+        }
+
+        /**
+         * @param k a K
+         * @return a size_type
+         * drops every value whose key is less than k and gives how many were dropped
+         */
+        size_type expire_before (const K& k) {
+            return _w.expire_before(k);
+        }
+
+        /**
+         * @return a T
+         * gives the largest value in the window
+         */
+        T max () const {
+            return _w.aggregate().second;
+        }
+
+        /**
+         * @return a T
+         * gives the smallest value in the window
+         */
+        T min () const {
+            return _w.aggregate().first;
+        }
+
+        /**
+         * removes the oldest value from the window
+         */
+        void pop () {
+            _w.pop();
+        }
+
+        /**
+         * @param v a T
+         * @param k a K
+         * adds v to the window
+         */
+        void push (const T& v, const K& k) {
+            _w.push(std::pair<T, T>(v, v), k);
+        }
+
+        /**
+         * @return a size_type
+         * gives the number of values in the window
+         */
+        size_type size () const {
+            return _w.size();
+        }
+};
+
+#endif // SlidingWindow_h
@@ -0,0 +1,541 @@
+// --------------------------
+// projects/deque/SoaDeque.h
+// --------------------------
+
+#ifndef SoaDeque_h
+#define SoaDeque_h
+
+// --------
+// includes
+// --------
+
+#include <cassert>  // assert
+#include <cstddef>  // ptrdiff_t, size_t
+#include <iterator> // random_access_iterator_tag
+#include <tuple>    // get, tuple, tuple_element
+
+#include "Deque.h"
+
+// -----------
+// soa_indices
+// -----------
+
+template <std::size_t... I>
+struct soa_indices {};
+
+template <std::size_t N, std::size_t... I>
+struct soa_make_indices : soa_make_indices<N - 1, N - 1, I...> {};
+
+template <std::size_t... I>
+struct soa_make_indices<0, I...> {
+    typedef soa_indices<I...> type;
+};
+
+// ------------
+// soa_iterator
+// ------------
+
+/**
+ * a random access iterator over the records of a soa_deque, by index
+ * dereferencing gives a tuple of references, one to each field of the record
+ */
+template <typename D, typename R>
+class soa_iterator {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename D::value_type          value_type;
+        typedef typename D::difference_type     difference_type;
+        typedef R                               reference;
+        typedef void                            pointer;
+
+    public:
+        friend bool operator == (const soa_iterator& lhs, const soa_iterator& rhs) {
+            return lhs.i == rhs.i;
+        }
+
+        friend bool operator != (const soa_iterator& lhs, const soa_iterator& rhs) {
+            return lhs.i != rhs.i;
+        }
+
+        friend bool operator < (const soa_iterator& lhs, const soa_iterator& rhs) {
+            return lhs.i < rhs.i;
+        }
+
+        friend soa_iterator operator + (soa_iterator lhs, difference_type rhs) {
+            return lhs += rhs;
+        }
+
+        friend soa_iterator operator - (soa_iterator lhs, difference_type rhs) {
+            return lhs -= rhs;
+        }
+
+        friend difference_type operator - (const soa_iterator& lhs, const soa_iterator& rhs) {
+            return lhs.i - rhs.i;
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        D*              p;
+        difference_type i;
+
+    public:
+        /**
+         * @param x a soa_deque pointer
+         * @param y a difference_type
+         * @return a new soa_iterator pointing to record y of x
+         */
+        soa_iterator (D* x, difference_type y) :
+                p (x), i (y)
+            {}
+
+        /**
+         * @param that a soa_iterator over the same records with another reference type
+         * @return a new soa_iterator pointing where that points
+         */
+        template <typename E, typename S>
+        soa_iterator (const soa_iterator<E, S>& that) :
+                p (that.p), i (that.i)
+            {}
+
+        reference operator * () const {
+            return (*p)[i];
+        }
+
+        reference operator [] (difference_type d) const {
+            return (*p)[i + d];
+        }
+
+        soa_iterator& operator ++ () {
+            ++i;
+            return *this;
+        }
+
+        soa_iterator operator ++ (int) {
+            soa_iterator x = *this;
+            ++i;
+            return x;
+        }
+
+        soa_iterator& operator -- () {
+            --i;
+            return *this;
+        }
+
+        soa_iterator operator -- (int) {
+            soa_iterator x = *this;
+            --i;
+            return x;
+        }
+
+        soa_iterator& operator += (difference_type d) {
+            i += d;
+            return *this;
+        }
+
+        soa_iterator& operator -= (difference_type d) {
+            i -= d;
+            return *this;
+        }
+
+        template <typename E, typename S>
+        friend class soa_iterator;
+};
+
+// ---------
+// soa_deque
+// ---------
+
+/**
+ * a deque of records stored as one MyDeque per field
+ *
+ * Every field container sees the same pushes and pops, so they grow their block maps in lockstep
+ * and the same index lands at the same block and offset in each of them. A pass that reads one
+ * field walks only that field's blocks, through for_each_segment.
+ */
+template <typename... Fields>
+class soa_deque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef std::tuple<Fields...>        value_type;
+        typedef std::tuple<Fields&...>       reference;
+        typedef std::tuple<const Fields&...> const_reference;
+
+        typedef std::size_t                  size_type;
+        typedef std::ptrdiff_t               difference_type;
+
+        typedef soa_iterator<soa_deque, reference>             iterator;
+        typedef soa_iterator<const soa_deque, const_reference> const_iterator;
+
+        /**
+         * the type of field I and the MyDeque holding it
+         */
+        template <std::size_t I>
+        struct field_type {
+            typedef typename std::tuple_element<I, value_type>::type type;
+            typedef MyDeque<type>                                    container_type;
+        };
+
+    private:
+        typedef typename soa_make_indices<sizeof...(Fields)>::type indices;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs a soa_deque reference
+         * @param rhs a soa_deque reference
+         * @return a bool
+         * checks if two soa_deque objects hold the same records
+         */
+        friend bool operator == (const soa_deque& lhs, const soa_deque& rhs) {
+            return lhs._x == rhs._x;
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        std::tuple<MyDeque<Fields>...> _x;
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        template <std::size_t... I>
+        bool valid (soa_indices<I...>) const {
+            const size_type s[] = {std::get<I>(_x).size()...};
+            for (size_type k = 1; k != sizeof...(I); ++k) {
+                if (s[k] != s[0]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool valid () const {
+            return valid(indices());
+        }
+
+        // ----
+        // trim
+        // ----
+
+        /**
+         * @param x a MyDeque reference
+         * @param s a size_type
+         * @param back a bool
+         * pops from the back, or the front, of x if it holds more than s elements
+         */
+        template <typename F>
+        static void trim (MyDeque<F>& x, size_type s, bool back) {
+            if (x.size() > s) {
+                if (back) {
+                    x.pop_back();
+                }
+                else {
+                    x.pop_front();
+                }
+            }
+        }
+
+        /**
+         * @param s a size_type
+         * @param back a bool
+         * puts the fields back in step after a push that threw part way through
+         */
+        template <std::size_t... I>
+        void trim (soa_indices<I...>, size_type s, bool back) {
+            int a[] = {0, (trim(std::get<I>(_x), s, back), 0)...};
+            (void) a;
+        }
+
+        template <std::size_t... I>
+        void put_back (soa_indices<I...>, const Fields&... v) {
+            int a[] = {0, (std::get<I>(_x).push_back(v), 0)...};
+            (void) a;
+        }
+
+        template <std::size_t... I>
+        void put_front (soa_indices<I...>, const Fields&... v) {
+            int a[] = {0, (std::get<I>(_x).push_front(v), 0)...};
+            (void) a;
+        }
+
+        template <std::size_t... I>
+        void take_back (soa_indices<I...>) {
+            int a[] = {0, (std::get<I>(_x).pop_back(), 0)...};
+            (void) a;
+        }
+
+        template <std::size_t... I>
+        void take_front (soa_indices<I...>) {
+            int a[] = {0, (std::get<I>(_x).pop_front(), 0)...};
+            (void) a;
+        }
+
+        template <std::size_t... I>
+        void resize (soa_indices<I...>, size_type s, const value_type& v) {
+            int a[] = {0, (std::get<I>(_x).resize(s, std::get<I>(v)), 0)...};
+            (void) a;
+        }
+
+        template <std::size_t... I>
+        void swap (soa_indices<I...>, soa_deque& rhs) {
+            int a[] = {0, (std::get<I>(_x).swap(std::get<I>(rhs._x)), 0)...};
+            (void) a;
+        }
+
+        template <std::size_t... I>
+        reference record (soa_indices<I...>, size_type index) {
+            return reference(std::get<I>(_x).unchecked_at(index)...);
+        }
+
+        template <std::size_t... I>
+        const_reference record (soa_indices<I...>, size_type index) const {
+            return const_reference(std::get<I>(_x).unchecked_at(index)...);
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        // Default constructor, copy, destructor, and copy assignment.
+        // soa_deque ();
+        // soa_deque (const soa_deque&);
+        // ~soa_deque ();
+        // soa_deque& operator = (const soa_deque&);
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param index a size_type
+         * @return a reference, a tuple of references to the fields of record index
+         */
+        reference operator [] (size_type index) {
+            assert(index < size());
+            return record(indices(), index);
+        }
+
+        /**
+         * @param index a size_type
+         * @return a const_reference, a tuple of references to the fields of record index
+         */
+        const_reference operator [] (size_type index) const {
+            assert(index < size());
+            return record(indices(), index);
+        }
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @return a reference to the fields of the last record
+         */
+        reference back () {
+            assert(!empty());
+            return (*this)[size() - 1];
+        }
+
+        // -----
+        // begin
+        // -----
+
+        iterator begin () {
+            return iterator(this, 0);
+        }
+
+        const_iterator begin () const {
+            return const_iterator(this, 0);
+        }
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * removes every record
+         */
+        void clear () {
+            resize(0);
+        }
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return std::get<0>(_x).empty();
+        }
+
+        // ---
+        // end
+        // ---
+
+        iterator end () {
+            return iterator(this, size());
+        }
+
+        const_iterator end () const {
+            return const_iterator(this, size());
+        }
+
+        // -----
+        // field
+        // -----
+
+        /**
+         * @return the MyDeque holding field I of every record
+         */
+        template <std::size_t I>
+        const typename field_type<I>::container_type& field () const {
+            return std::get<I>(_x);
+        }
+
+        // ----------------
+        // for_each_segment
+        // ----------------
+
+        /**
+         * @param f a function taking a pointer to the first element of a run and one past its last
+         * @return f
+         * calls f on each contiguous run of field I, front to back
+         */
+        template <std::size_t I, typename F>
+        F for_each_segment (F f) {
+            return std::get<I>(_x).for_each_segment(f);
+        }
+
+        /**
+         * @param f a function taking a const pointer to the first element of a run and one past its last
+         * @return f
+         * calls f on each contiguous run of field I, front to back
+         */
+        template <std::size_t I, typename F>
+        F for_each_segment (F f) const {
+            return std::get<I>(_x).for_each_segment(f);
+        }
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return a reference to the fields of the first record
+         */
+        reference front () {
+            assert(!empty());
+            return (*this)[0];
+        }
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * removes the last record
+         */
+        void pop_back () {
+            assert(!empty());
+            take_back(indices());
+            assert(valid());
+        }
+
+        /**
+         * removes the first record
+         */
+        void pop_front () {
+            assert(!empty());
+            take_front(indices());
+            assert(valid());
+        }
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * @param v the fields of a record
+         * adds a record after the last one
+         */
+        void push_back (const Fields&... v) {
+            size_type s = size();
+            try {
+                put_back(indices(), v...);
+            }
+            catch (...) {
+                trim(indices(), s, true);
+                throw;
+            }
+            assert(valid());
+        }
+
+        /**
+         * @param v the fields of a record
+         * adds a record before the first one
+         */
+        void push_front (const Fields&... v) {
+            size_type s = size();
+            try {
+                put_front(indices(), v...);
+            }
+            catch (...) {
+                trim(indices(), s, false);
+                throw;
+            }
+            assert(valid());
+        }
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * @param s a size_type
+         * @param v a value_type
+         * resizes a soa_deque so it holds s records, filling with v
+         */
+        void resize (size_type s, const value_type& v = value_type()) {
+            resize(indices(), s, v);
+            assert(valid());
+        }
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return std::get<0>(_x).size();
+        }
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param rhs a soa_deque reference
+         * swaps the records of two soa_deque objects
+         */
+        void swap (soa_deque& rhs) {
+            swap(indices(), rhs);
+        }
+};
+
+#endif // SoaDeque_h
@@ -0,0 +1,350 @@
+// -----------------------------
+// projects/deque/SortedDeque.h
+// -----------------------------
+
+#ifndef SortedDeque_h
+#define SortedDeque_h
+#define FENCE_WIDTH  32
+#define FENCE_LEVELS 2
+
+// --------
+// includes
+// --------
+
+#include <algorithm>  // fill, max, min, partition_point
+#include <cassert>    // assert
+#include <functional> // less
+#include <memory>     // allocator
+#include <utility>    // pair
+#include <vector>     // vector
+
+#include "Deque.h"
+
+// -------------
+// MySortedDeque
+// -------------
+
+/**
+ * a MyDeque of keys appended in order and expired from the front, such as timestamps, that
+ * answers lower_bound, upper_bound and equal_range without walking the MyDeque
+ *
+ * Next to the keys sit FENCE_LEVELS plain arrays, the fences. Fence L holds the key at every
+ * FENCE_WIDTH^(L + 1)-th position, counted from the first key pushed since the last clear. A
+ * search runs a binary search over the top fence, a thousandth the size of the keys, and then over
+ * at most FENCE_WIDTH + 1 entries of each fence below it and over at most FENCE_WIDTH keys.
+ * Because positions are counted from the first key pushed, pop_front only drops fence entries
+ * when it expires a whole group, and it never shifts the entries that are left. The first entry of
+ * a fence may belong to a key that is already gone. That key is no more than the keys left in its
+ * group, so the entry still separates the groups.
+ */
+template < typename T, typename C = std::less<T>, typename A = std::allocator<T> >
+class MySortedDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef MyDeque<T, A>                           container_type;
+        typedef C                                       key_compare;
+        typedef typename container_type::value_type     value_type;
+        typedef typename container_type::size_type      size_type;
+        typedef typename container_type::const_iterator const_iterator;
+
+    private:
+        // ----
+        // data
+        // ----
+
+        container_type _x;
+        std::vector<T> _f[FENCE_LEVELS];    // the key at every stride(L)-th position, from _f0[L] on
+        size_type      _f0[FENCE_LEVELS];   // entries of expired groups, still at the front
+        size_type      _gone;               // keys popped since the last clear
+        C              _c;
+
+    private:
+        // ------
+        // stride
+        // ------
+
+        /**
+         * @return the positions between the entries of fence l
+         */
+        static size_type stride (size_type l) {
+            size_type s = FENCE_WIDTH;
+            while (l--) {
+                s *= FENCE_WIDTH;
+            }
+            return s;
+        }
+
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            for (size_type l = 0; l != FENCE_LEVELS; ++l) {
+                size_type s = stride(l);
+                size_type b = _gone / s;
+                size_type e = (_gone + size() + s - 1) / s;
+                if ((_f0[l] > _f[l].size()) || (_f[l].size() - _f0[l] != e - b)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // -----
+        // bound
+        // -----
+
+        /**
+         * @param p a unary predicate, true for a prefix of the keys and false for the rest
+         * @return the index of the first key p is false for, or size()
+         * narrows the positions the boundary can sit at, [lo, hi], one fence at a time from the top
+         * and then searches the keys left
+         */
+        template <typename P>
+        size_type bound (P p) const {
+            size_type lo = _gone;
+            size_type hi = _gone + size();
+            for (size_type l = FENCE_LEVELS; l-- && lo != hi;) {
+                size_type s = stride(l);
+                const T*  f = _f[l].data() + _f0[l] + (lo / s - _gone / s);
+                size_type c = std::partition_point(f, f + ((hi - 1) / s - lo / s + 1), p) - f;
+                if (!c) {
+                    return lo - _gone;
+                }
+                size_type g = (lo / s + c - 1) * s;
+                lo = std::max(lo, g);
+                hi = std::min(hi, g + s);
+            }
+            lo -= _gone;
+            size_type n = hi - _gone - lo;
+            while (n) {
+                size_type h = n / 2;
+                if (p(_x.unchecked_at(lo + h))) {
+                    lo += h + 1;
+                    n  -= h + 1;
+                }
+                else {
+                    n = h;
+                }
+            }
+            return lo;
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param c a key_compare
+         * @param a an allocator
+         * @return a MySortedDeque object
+         * makes an empty MySortedDeque ordered by c
+         */
+        explicit MySortedDeque (const C& c = C(), const A& a = A()) :
+                _x (a), _gone (0), _c (c) {
+            std::fill(_f0, _f0 + FENCE_LEVELS, 0);
+            assert(valid());
+        }
+
+        // Default copy, destructor, and copy assignment.
+        // MySortedDeque (const MySortedDeque&);
+        // ~MySortedDeque ();
+        // MySortedDeque& operator = (const MySortedDeque&);
+
+        // -----------
+        // operator []
+        // -----------
+
+        const T& operator [] (size_type index) const {
+            return _x[index];
+        }
+
+        // ----
+        // back
+        // ----
+
+        const T& back () const {
+            return _x.back();
+        }
+
+        // -----
+        // begin
+        // -----
+
+        const_iterator begin () const {
+            return _x.begin();
+        }
+
+        // -----
+        // clear
+        // -----
+
+        void clear () {
+            _x.clear();
+            for (size_type l = 0; l != FENCE_LEVELS; ++l) {
+                _f[l].clear();
+                _f0[l] = 0;
+            }
+            _gone = 0;
+            assert(valid());
+        }
+
+        // -----
+        // empty
+        // -----
+
+        bool empty () const {
+            return _x.empty();
+        }
+
+        // ---
+        // end
+        // ---
+
+        const_iterator end () const {
+            return _x.end();
+        }
+
+        // -----------
+        // equal_range
+        // -----------
+
+        /**
+         * @param k a key
+         * @return the keys equal to k, as lower_bound(k) and upper_bound(k)
+         */
+        std::pair<const_iterator, const_iterator> equal_range (const T& k) const {
+            return std::make_pair(lower_bound(k), upper_bound(k));
+        }
+
+        // -------------
+        // expire_before
+        // -------------
+
+        /**
+         * @param k a key
+         * @return the number of keys dropped
+         * drops every key less than k
+         */
+        size_type expire_before (const T& k) {
+            size_type n = lower_index(k);
+            pop_front_n(n);
+            return n;
+        }
+
+        // -----
+        // front
+        // -----
+
+        const T& front () const {
+            return _x.front();
+        }
+
+        // -----------
+        // lower_bound
+        // -----------
+
+        /**
+         * @param k a key
+         * @return the first key not less than k, or end()
+         */
+        const_iterator lower_bound (const T& k) const {
+            return _x.begin() + lower_index(k);
+        }
+
+        /**
+         * @param k a key
+         * @return the index of the first key not less than k, or size()
+         */
+        size_type lower_index (const T& k) const {
+            const C& c = _c;
+            return bound([&c, &k] (const T& v) {return c(v, k);});
+        }
+
+        // ---------
+        // pop_front
+        // ---------
+
+        /**
+         * removes the first key
+         */
+        void pop_front () {
+            pop_front_n(1);
+        }
+
+        /**
+         * @param n a size_type, at most size()
+         * removes the first n keys, and the fence entries of the groups that leaves empty
+         */
+        void pop_front_n (size_type n) {
+            assert(n <= size());
+            if (n == size()) {
+                clear();
+                return;
+            }
+            _x.pop_front_n(n);
+            for (size_type l = 0; l != FENCE_LEVELS; ++l) {
+                size_type s = stride(l);
+                _f0[l] += (_gone + n) / s - _gone / s;
+                if (_f0[l] > _f[l].size() / 2) {
+                    _f[l].erase(_f[l].begin(), _f[l].begin() + _f0[l]);
+                    _f0[l] = 0;
+                }
+            }
+            _gone += n;
+            assert(valid());
+        }
+
+        // ---------
+        // push_back
+        // ---------
+
+        /**
+         * @param k a key, not less than back()
+         * adds k after the last key, and fence entries for the groups it starts
+         */
+        void push_back (const T& k) {
+            assert(empty() || !_c(k, back()));
+            size_type g = _gone + size();
+            for (size_type l = 0; l != FENCE_LEVELS && g % stride(l) == 0; ++l) {
+                _f[l].push_back(k);
+            }
+            _x.push_back(k);
+            assert(valid());
+        }
+
+        // ----
+        // size
+        // ----
+
+        size_type size () const {
+            return _x.size();
+        }
+
+        // -----------
+        // upper_bound
+        // -----------
+
+        /**
+         * @param k a key
+         * @return the first key greater than k, or end()
+         */
+        const_iterator upper_bound (const T& k) const {
+            return _x.begin() + upper_index(k);
+        }
+
+        /**
+         * @param k a key
+         * @return the index of the first key greater than k, or size()
+         */
+        size_type upper_index (const T& k) const {
+            const C& c = _c;
+            return bound([&c, &k] (const T& v) {return !c(k, v);});
+        }
+};
+
+#endif // SortedDeque_h
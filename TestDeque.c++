@@ -24,14 +24,33 @@
 #include <deque>     // deque
 #include <algorithm> // equal
 #include <iostream> // cout, endl
+#include <limits>   // numeric_limits
 #include <sstream>  // istringtstream, ostringstream
 #include <string>   // ==
+#include <vector>   // vector
 #include "Deque.h"
+#include "AlignedAllocator.h"
+#include "AsyncDeque.h"
+#include "ByteBuffer.h"
+#include "HugePageAllocator.h"
+#include "PackedDeque.h"
+#include "SlidingWindow.h"
+#include "SoaDeque.h"
+#include "SortedDeque.h"
+#include "TieredDeque.h"
 #include "gtest/gtest.h"
 #include <deque>
 #include <stdexcept> // invalid_argument
 #include <memory>   // allocator
+#include <new>      // bad_alloc
 #include <cstdlib>   // rand
+#include <cstddef>   // offsetof
+
+#ifdef __unix__
+#include <sys/socket.h> // AF_UNIX, socketpair
+#include <sys/uio.h>    // iovec, readv, writev
+#include <unistd.h>     // close, pipe, read, write
+#endif
 
 #define private public
 #define protected public
@@ -754,6 +773,63 @@ TEST(Push_Back, Test3) {
    ASSERT_THROW(x.at(39), out_of_range);
  }
 
+ TEST(Access_element_at, Test4) {
+   MyDeque<int> x;
+   deque<int> y;
+   for (int i = 0; i < 97; ++i) {
+       x.push_front(i);
+       y.push_front(i);
+       x.push_back(-i);
+       y.push_back(-i);
+   }
+   const MyDeque<int>& c = x;
+   for (size_t i = 0; i < y.size(); ++i) {
+       ASSERT_EQ(x[i], y[i]);
+       ASSERT_EQ(c[i], y[i]);
+       ASSERT_EQ(x.unchecked_at(i), y[i]);
+       ASSERT_EQ(c.at(i), y[i]);
+   }
+   ASSERT_THROW(c.at(y.size()), out_of_range);
+ }
+
+ TEST(Access_element_at, Test5) {
+   MyDeque<int> x;
+   for (int i = 0; i < 200; ++i) {
+       x.push_back(i * 3);
+   }
+   x.pop_front();
+   vector<size_t> index;
+   for (size_t i = 0; i < 199; ++i) {
+       index.push_back((i * 71) % 199);
+   }
+   vector<int> out;
+   x.gather(index.begin(), index.end(), back_inserter(out));
+   ASSERT_EQ(out.size(), 199);
+   for (size_t i = 0; i < index.size(); ++i) {
+       ASSERT_EQ(out[i], (int) (index[i] + 1) * 3);
+   }
+   const MyDeque<int> y;
+   MyDeque<int>       z(std::move(x));
+   out.clear();
+   y.gather(index.begin(), index.begin(), back_inserter(out));
+   x.gather(index.begin(), index.begin(), back_inserter(out));
+   ASSERT_TRUE(out.empty());
+ }
+
+ TEST(Access_element_at, Test6) {
+   MyDeque<int> x (45, 1);
+   x.copy_on_write(true);
+   MyDeque<int> y(x);
+   const MyDeque<int>& c = y;
+   ASSERT_EQ(c[44], 1);
+   x[44] = 2;
+   y.unchecked_at(0) = 3;
+   ASSERT_EQ(x[44], 2);
+   ASSERT_EQ(y[44], 1);
+   ASSERT_EQ(x[0], 1);
+   ASSERT_EQ(y[0], 3);
+ }
+
     
      // ---------
      // equals_to
@@ -908,3 +984,2145 @@ TEST(Push_Back, Test3) {
    for(int i = 0; i < 10; ++i)
    ASSERT_EQ((*b1)[i], 10.15);
  }
+
+     // ----
+     // sort
+     // ----
+
+ TEST(Sort, Test1) {
+   MyDeque<int> x(1000);
+   deque<int> y;
+   for (MyDeque<int>::iterator b = x.begin(); b != x.end(); ++b) {
+       *b = rand() % 500;
+       y.push_back(*b);
+   }
+   x.sort();
+   std::sort(y.begin(), y.end());
+   ASSERT_EQ(x.size(), 1000);
+   ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+ }
+
+ TEST(Sort, Test2) {
+   MyDeque<int> x(97, 0);
+   for (int i = 0; i < 7; ++i) {
+       x.pop_front();
+   }
+   deque<int> y;
+   for (MyDeque<int>::iterator b = x.begin(); b != x.end(); ++b) {
+       *b = rand();
+       y.push_back(*b);
+   }
+   x.sort(greater<int>(), 4);
+   std::sort(y.begin(), y.end(), greater<int>());
+   ASSERT_EQ(x.size(), 90);
+   ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+ }
+
+ TEST(Sort, Test3) {
+   MyDeque<int> x(45);
+   int v = 45;
+   for (MyDeque<int>::iterator b = x.begin(); b != x.end(); ++b) {
+       *b = v--;
+   }
+   std::sort(x.begin(), x.end());
+   ASSERT_EQ(x.end() - x.begin(), 45);
+   ASSERT_EQ(x.front(), 1);
+   ASSERT_EQ(x.back(), 45);
+   ASSERT_TRUE(std::is_sorted(x.begin(), x.end()));
+ }
+
+ TEST(Stable_sort, Test1) {
+   MyDeque< pair<int, int> > x(333);
+   int i = 0;
+   for (MyDeque< pair<int, int> >::iterator b = x.begin(); b != x.end(); ++b) {
+       *b = make_pair(rand() % 10, i++);
+   }
+   struct by_first {
+       bool operator () (const pair<int, int>& lhs, const pair<int, int>& rhs) const {
+           return lhs.first < rhs.first;}};
+   x.stable_sort(by_first(), 3);
+   MyDeque< pair<int, int> >::iterator b = x.begin();
+   MyDeque< pair<int, int> >::iterator p = b++;
+   while (b != x.end()) {
+       ASSERT_TRUE(p->first < b->first || (p->first == b->first && p->second < b->second));
+       p = b++;
+   }
+ }
+
+ TEST(Stable_sort, Test2) {
+   MyDeque<string> x(61, "b");
+   x.front() = "c";
+   x.back()  = "a";
+   x.stable_sort();
+   ASSERT_EQ(x.size(), 61);
+   ASSERT_EQ(x.front(), "a");
+   ASSERT_EQ(x.back(), "c");
+ }
+
+     // ------------
+     // push and pop
+     // ------------
+
+ TEST(Push_Pop, Test1) {
+   MyDeque<int> x;
+   deque<int> y;
+   for (int i = 0; i < 500; ++i) {
+       x.push_back(i);
+       y.push_back(i);
+       x.push_front(-i);
+       y.push_front(-i);
+       if (i % 3 == 0) {
+           x.pop_front();
+           y.pop_front();
+           x.pop_back();
+           y.pop_back();
+       }
+   }
+   ASSERT_EQ(x.size(), y.size());
+   ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+ }
+
+ TEST(Push_Pop, Test2) {
+   MyDeque<string> x;
+   for (int i = 0; i < 1000; ++i) {
+       x.push_back("a");
+       x.pop_front();
+   }
+   ASSERT_TRUE(x.empty());
+   x.push_back("b");
+   ASSERT_EQ(x.front(), "b");
+   ASSERT_EQ(x.back(), "b");
+ }
+
+     // -------------
+     // SlidingWindow
+     // -------------
+
+ TEST(SlidingWindow, Test1) {
+   MySlidingWindow<int, window_min<int> > w;
+   deque< pair<int, int> > y;
+   for (int t = 0; t < 1000; ++t) {
+       int v = rand() % 1000;
+       w.push(v, t);
+       y.push_back(make_pair(v, t));
+       w.expire_before(t - 50);
+       while (y.front().second < t - 50) {
+           y.pop_front();
+       }
+       int m = y.front().first;
+       for (size_t i = 0; i != y.size(); ++i) {
+           m = min(m, y[i].first);
+       }
+       ASSERT_EQ(w.size(), y.size());
+       ASSERT_EQ(w.aggregate(), m);
+   }
+ }
+
+ TEST(SlidingWindow, Test2) {
+   struct concat {
+       string operator () (const string& lhs, const string& rhs) const {
+           return lhs + rhs;}};
+   MySlidingWindow<string, concat, int> w;
+   w.push("a", 1);
+   w.push("b", 2);
+   w.push("c", 3);
+   ASSERT_EQ(w.aggregate(), "abc");
+   ASSERT_EQ(w.expire_before(2), 1);
+   ASSERT_EQ(w.aggregate(), "bc");
+   w.push("d", 4);
+   ASSERT_EQ(w.aggregate(), "bcd");
+   w.pop();
+   w.pop();
+   ASSERT_EQ(w.aggregate(), "d");
+   w.pop();
+   ASSERT_TRUE(w.empty());
+ }
+
+ TEST(SlidingWindow, Test3) {
+   MySlidingMinMax<double> w;
+   w.push(3.5, 10);
+   w.push(-1.0, 11);
+   w.push(7.25, 12);
+   ASSERT_EQ(w.min(), -1.0);
+   ASSERT_EQ(w.max(), 7.25);
+   w.expire_before(12);
+   ASSERT_EQ(w.size(), 1);
+   ASSERT_EQ(w.min(), 7.25);
+   ASSERT_EQ(w.max(), 7.25);
+ }
+
+     // ---------------
+     // bounded MyDeque
+     // ---------------
+
+ int allocations = 0;
+
+ template <typename T>
+ struct counting_allocator : std::allocator<T> {
+     static size_t made;    // allocations of Ts
+     static size_t freed;   // deallocations of Ts
+     static size_t limit;   // allocations of Ts allowed before one throws, 0 for no limit
+
+     template <typename U>
+     struct rebind {
+         typedef counting_allocator<U> other;};
+
+     counting_allocator () {}
+
+     template <typename U>
+     counting_allocator (const counting_allocator<U>&) {}
+
+     static void reset () {
+         made = freed = 0;}
+
+     T* allocate (size_t n) {
+         if (limit && made == limit) {
+             throw std::bad_alloc();}
+         ++allocations;
+         ++made;
+         return std::allocator<T>::allocate(n);}
+
+     void deallocate (T* p, size_t n) {
+         ++freed;
+         std::allocator<T>::deallocate(p, n);}};
+
+ template <typename T>
+ size_t counting_allocator<T>::made = 0;
+
+ template <typename T>
+ size_t counting_allocator<T>::freed = 0;
+
+ template <typename T>
+ size_t counting_allocator<T>::limit = 0;
+
+ TEST(Bounded, Test1) {
+   MyDeque<int> x(50, overwrite_oldest);
+   ASSERT_EQ(x.capacity(), 50);
+   for (int i = 0; i < 200; ++i) {
+       ASSERT_TRUE(x.push_back(i));
+   }
+   ASSERT_TRUE(x.full());
+   ASSERT_EQ(x.size(), 50);
+   ASSERT_EQ(x.front(), 150);
+   ASSERT_EQ(x.back(), 199);
+   int i = 150;
+   for (MyDeque<int>::iterator b = x.begin(); b != x.end(); ++b) {
+       ASSERT_EQ(*b, i++);
+   }
+ }
+
+ TEST(Bounded, Test2) {
+   MyDeque<int> x(3, reject_newest);
+   ASSERT_TRUE(x.push_back(1));
+   ASSERT_TRUE(x.push_back(2));
+   ASSERT_TRUE(x.push_front(0));
+   ASSERT_FALSE(x.push_back(3));
+   ASSERT_FALSE(x.push_front(-1));
+   ASSERT_TRUE(x.insert(x.begin(), 5) == x.end());
+   ASSERT_EQ(x.front(), 0);
+   ASSERT_EQ(x.back(), 2);
+   ASSERT_THROW(x.resize(4), length_error);
+   x.pop_front();
+   ASSERT_TRUE(x.push_back(3));
+   ASSERT_EQ(x.back(), 3);
+ }
+
+ TEST(Bounded, Test3) {
+   MyDeque<int> x(5, overwrite_oldest);
+   for (int i = 0; i < 5; ++i) {
+       x.push_back(i);
+   }
+   x.push_front(-1);
+   ASSERT_EQ(x.front(), -1);
+   ASSERT_EQ(x.back(), 3);
+   x.insert(x.begin() + 2, 9);
+   ASSERT_EQ(x.size(), 5);
+   ASSERT_EQ(x.front(), 0);
+   ASSERT_EQ(*(x.begin() + 1), 9);
+ }
+
+ TEST(Bounded, Test4) {
+   MyDeque<string, counting_allocator<string> > x(1000, overwrite_oldest);
+   int n = allocations;
+   for (int i = 0; i < 100000; ++i) {
+       x.push_back("event");
+   }
+   ASSERT_EQ(allocations, n);
+   ASSERT_EQ(x.size(), 1000);
+ }
+
+ TEST(Bounded, Test5) {
+   const string a(100, 'a');
+   const string b(100, 'b');
+   const string c(100, 'c');
+   MyDeque<string> x(3, overwrite_oldest);
+   x.push_back(a);
+   x.push_back(b);
+   x.push_back(c);
+   x.push_back(x.front());
+   ASSERT_EQ(x.front(), b);
+   ASSERT_EQ(x.back(),  a);
+   x.push_front(x.back());
+   ASSERT_EQ(x.front(), a);
+   ASSERT_EQ(x.back(),  c);
+   x.insert(x.begin() + 1, x.front());
+   ASSERT_EQ(x.size(), 3);
+   ASSERT_EQ(x.front(), a);
+   ASSERT_EQ(x[1],      b);
+   ASSERT_EQ(x.back(),  c);
+ }
+
+ TEST(Bounded, Test6) {
+   ASSERT_THROW(MyDeque<int>(0, reject_newest), length_error);
+   ASSERT_THROW(MyDeque<int>(0, overwrite_oldest), length_error);
+   MyDeque<int> x(1, reject_newest);
+   ASSERT_EQ(x.capacity(), 1);
+   ASSERT_TRUE(x.push_back(1));
+   ASSERT_FALSE(x.push_back(2));
+   ASSERT_EQ(x.size(), 1);
+ }
+
+ TEST(Bounded, Test7) {
+   MyDeque<int> x(50, overwrite_oldest);
+   for (int i = 0; i < 60; ++i) {
+       x.push_back(i);
+   }
+   MyDeque<int> y(std::move(x));
+   ASSERT_EQ(y.capacity(), 50);
+   ASSERT_EQ(y.front(), 10);
+   ASSERT_TRUE(x.empty());
+   ASSERT_EQ(x.capacity(), 0);
+   for (int i = 0; i < 100; ++i) {
+       x.push_back(i);
+       x.push_front(-i);
+   }
+   ASSERT_EQ(x.size(), 200);
+   ASSERT_EQ(x.front(), -99);
+   ASSERT_EQ(x.back(), 99);
+ }
+
+     // -------------
+     // copy on write
+     // -------------
+
+ TEST(Copy_on_write, Test1) {
+   MyDeque<int> x(500, 1);
+   x.copy_on_write(true);
+   MyDeque<int> y(x);
+   ASSERT_TRUE(y.copy_on_write());
+   *(y.begin() + 250) = 2;
+   y.push_back(3);
+   y.pop_front();
+   ASSERT_EQ(x.size(), 500);
+   ASSERT_EQ(y.size(), 500);
+   ASSERT_EQ(*(x.begin() + 250), 1);
+   ASSERT_EQ(*(y.begin() + 249), 2);
+   ASSERT_EQ(x.back(), 1);
+   ASSERT_EQ(y.back(), 3);
+   x.push_front(0);
+   ASSERT_EQ(x.front(), 0);
+   ASSERT_EQ(y.front(), 1);
+ }
+
+ TEST(Copy_on_write, Test2) {
+   MyDeque<int, counting_allocator<int> > x;
+   x.copy_on_write(true);
+   for (int i = 0; i < 10000; ++i) {
+       x.push_back(i);
+   }
+   MyDeque<int, counting_allocator<int> > y(x);
+   int n = allocations;
+   MyDeque<int, counting_allocator<int> > z(x);
+   ASSERT_EQ(allocations - n, 2);
+   n = allocations;
+   *(z.begin() + 5000) = -1;
+   ASSERT_EQ(allocations - n, 1);
+   ASSERT_EQ(*(x.begin() + 5000), 5000);
+   ASSERT_EQ(*(y.begin() + 5000), 5000);
+ }
+
+ TEST(Copy_on_write, Test3) {
+   MyDeque<string>* x = new MyDeque<string>(45, "abc");
+   x->copy_on_write(true);
+   MyDeque<string> y;
+   y = *x;
+   MyDeque<string> z(y);
+   delete x;
+   z.clear();
+   ASSERT_TRUE(z.empty());
+   ASSERT_EQ(y.size(), 45);
+   y.sort();
+   ASSERT_EQ(y.front(), "abc");
+   ASSERT_EQ(y.back(), "abc");
+ }
+
+ TEST(Copy_on_write, Test4) {
+   typedef MyDeque<int, counting_allocator<int> > deque_type;
+   deque_type x;
+   x.copy_on_write(true);
+   for (int i = 0; i < 1000; ++i) {
+       x.push_back(i);
+   }
+   const deque_type  y(x);
+   const deque_type& z = x;
+   const size_t s = y.shared_blocks();
+   ASSERT_EQ(s, x.shared_blocks());
+   ASSERT_TRUE(s > 0);
+   const int* f = &y.front();
+   const int* b = &y.back();
+   int n = allocations;
+   ASSERT_EQ(y.front(), 0);
+   ASSERT_EQ(y.back(), 999);
+   ASSERT_EQ(z.back(), 999);
+   ASSERT_EQ(y[500], 500);
+   ASSERT_EQ(allocations, n);
+   ASSERT_EQ(y.shared_blocks(), s);
+   ASSERT_EQ(&y.front(), f);
+   ASSERT_EQ(&y.back(), b);
+   ASSERT_EQ(&z.front(), f);
+ }
+
+ TEST(Copy_on_write, Test5) {
+   MyDeque<int> x(20, 1);
+   x.copy_on_write(true);
+   MyDeque<int> y(10, reject_newest);
+   ASSERT_THROW(y = x, length_error);
+   x.resize(5);
+   y = x;
+   ASSERT_EQ(y.capacity(), 10);
+   ASSERT_FALSE(y.copy_on_write());
+   ASSERT_TRUE(y == x);
+   for (int i = 0; i != 10; ++i) {
+       y.push_back(2);
+   }
+   ASSERT_EQ(y.size(), 10);
+   ASSERT_EQ(x.size(), 5);
+   MyDeque<int> z;
+   z.gradual_growth(true);
+   z = x;
+   ASSERT_FALSE(z.copy_on_write());
+   ASSERT_TRUE(z.gradual_growth());
+   ASSERT_EQ(z.capacity(), 0);
+   ASSERT_TRUE(z == x);
+   z.push_front(0);
+   ASSERT_EQ(x.front(), 1);
+ }
+
+     // ------------------
+     // splice and split_at
+     // ------------------
+
+ TEST(Splice, Test1) {
+   MyDeque<int> x;
+   MyDeque<int> y;
+   for (int i = 0; i < 47; ++i) {
+       x.push_back(i);
+   }
+   for (int i = 47; i < 200; ++i) {
+       y.push_back(i);
+   }
+   x.splice_back(std::move(y));
+   ASSERT_TRUE(y.empty());
+   ASSERT_EQ(x.size(), 200);
+   int i = 0;
+   for (MyDeque<int>::iterator b = x.begin(); b != x.end(); ++b) {
+       ASSERT_EQ(*b, i++);
+   }
+   y.push_back(7);
+   ASSERT_EQ(y.front(), 7);
+ }
+
+ TEST(Splice, Test2) {
+   MyDeque<int> x(30, 1);
+   MyDeque<int> y;
+   for (int i = 0; i < 73; ++i) {
+       y.push_front(i);
+   }
+   x.splice_front(std::move(y));
+   ASSERT_TRUE(y.empty());
+   ASSERT_EQ(x.size(), 103);
+   ASSERT_EQ(x.front(), 72);
+   ASSERT_EQ(*(x.begin() + 72), 0);
+   ASSERT_EQ(*(x.begin() + 73), 1);
+   ASSERT_EQ(x.back(), 1);
+ }
+
+ TEST(Splice, Test3) {
+   deque<string> z;
+   MyDeque<string> x;
+   for (int k = 0; k < 20; ++k) {
+       MyDeque<string> y;
+       deque<string> w;
+       int n = rand() % 60;
+       for (int i = 0; i < n; ++i) {
+           string s(1, 'a' + rand() % 26);
+           if (rand() % 2) {
+               y.push_back(s);
+               w.push_back(s);
+           }
+           else {
+               y.push_front(s);
+               w.push_front(s);
+           }
+       }
+       if (k % 2) {
+           x.splice_back(std::move(y));
+           z.insert(z.end(), w.begin(), w.end());
+       }
+       else {
+           x.splice_front(std::move(y));
+           z.insert(z.begin(), w.begin(), w.end());
+       }
+       ASSERT_EQ(x.size(), z.size());
+       ASSERT_TRUE(std::equal(z.begin(), z.end(), x.begin()));
+   }
+ }
+
+ TEST(Split_at, Test1) {
+   MyDeque<string> x;
+   deque<string> y;
+   for (int i = 0; i < 150; ++i) {
+       x.push_front(to_string(i));
+       y.push_front(to_string(i));
+   }
+   for (size_t index = 0; index <= 150; index += 7) {
+       MyDeque<string> a(x);
+       MyDeque<string> b = a.split_at(index);
+       ASSERT_EQ(a.size(), index);
+       ASSERT_EQ(b.size(), 150 - index);
+       ASSERT_TRUE(std::equal(a.begin(), a.end(), y.begin()));
+       ASSERT_TRUE(std::equal(b.begin(), b.end(), y.begin() + index));
+       a.push_back("x");
+       b.push_front("y");
+       a.splice_back(std::move(b));
+       ASSERT_EQ(a.size(), 152);
+   }
+ }
+
+ TEST(Splice, Test4) {
+   MyDeque<int, counting_allocator<int> > x;
+   MyDeque<int, counting_allocator<int> > y;
+   for (int i = 0; i < 47; ++i) {
+       x.push_back(i);
+   }
+   for (int i = 0; i < 7; ++i) {
+       y.push_back(0);
+       y.pop_front();
+   }
+   for (int i = 47; i < 2000; ++i) {
+       y.push_back(i);
+   }
+   int n = allocations;
+   x.splice_back(std::move(y));
+   ASSERT_LE(allocations - n, 1);
+   ASSERT_EQ(x.size(), 2000);
+   int i = 0;
+   for (MyDeque<int, counting_allocator<int> >::iterator b = x.begin(); b != x.end(); ++b) {
+       ASSERT_EQ(*b, i++);
+   }
+ }
+
+ TEST(Splice, Test5) {
+   MyDeque<int> x(5, reject_newest);
+   MyDeque<int> y;
+   for (int i = 0; i < 4; ++i) {
+       x.push_back(i);
+       y.push_back(10 + i);
+   }
+   ASSERT_THROW(x.splice_back(std::move(y)), length_error);
+   ASSERT_THROW(x.splice_front(std::move(y)), length_error);
+   ASSERT_EQ(x.size(), 4);
+   ASSERT_EQ(y.size(), 4);
+   ASSERT_EQ(y.front(), 10);
+   ASSERT_EQ(y.back(), 13);
+   y.pop_front_n(3);
+   x.splice_front(std::move(y));
+   ASSERT_TRUE(y.empty());
+   ASSERT_TRUE(x.full());
+   ASSERT_EQ(x.front(), 13);
+   ASSERT_EQ(x.back(), 3);
+ }
+
+    // ----
+    // Size
+    // ----
+
+ TEST(Size, Test1) {
+   MyDeque<int> x;
+   ASSERT_TRUE(x.empty());
+   for (int i = 0; i < 300; ++i) {
+       if (i % 3) {
+           x.push_back(i);
+       }
+       else {
+           x.push_front(i);
+       }
+       if (i % 7 == 0) {
+           x.pop_front();
+       }
+       ASSERT_EQ(x.size(), (size_t) std::distance(x.begin(), x.end()));
+   }
+   MyDeque<int> y = x.split_at(100);
+   ASSERT_EQ(x.size(), 100);
+   ASSERT_EQ(y.size(), (size_t) std::distance(y.begin(), y.end()));
+   x.splice_back(std::move(y));
+   ASSERT_TRUE(y.empty());
+   ASSERT_EQ(x.size(), (size_t) std::distance(x.begin(), x.end()));
+   x.resize(17);
+   ASSERT_EQ(x.size(), 17);
+   x.clear();
+   ASSERT_TRUE(x.empty());
+ }
+
+    // ------
+    // Tiered
+    // ------
+
+ TEST(Tiered, Test1) {
+   MyTieredDeque<int> x;
+   deque<int> y;
+   for (int i = 0; i < 5000; ++i) {
+       size_t index = y.empty() ? 0 : rand() % (y.size() + 1);
+       ASSERT_EQ(*x.insert(x.begin() + index, i), i);
+       y.insert(y.begin() + index, i);
+   }
+   ASSERT_EQ(x.size(), y.size());
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+   for (size_t i = 0; i < y.size(); i += 13) {
+       ASSERT_EQ(x[i], y[i]);
+   }
+ }
+
+ TEST(Tiered, Test2) {
+   MyTieredDeque<string> x;
+   deque<string> y;
+   for (int i = 0; i < 3000; ++i) {
+       x.push_back(to_string(i));
+       y.push_back(to_string(i));
+       x.push_front(to_string(-i));
+       y.push_front(to_string(-i));
+   }
+   while (y.size() > 10) {
+       size_t index = rand() % y.size();
+       MyTieredDeque<string>::iterator p = x.erase(x.begin() + index);
+       y.erase(y.begin() + index);
+       ASSERT_EQ(p - x.begin(), (long) index);
+       if (index % 50 == 0) {
+           x.pop_front();
+           y.pop_front();
+           x.pop_back();
+           y.pop_back();
+       }
+   }
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+   ASSERT_EQ(x.front(), y.front());
+   ASSERT_EQ(x.back(), y.back());
+ }
+
+ TEST(Tiered, Test3) {
+   MyTieredDeque<int> x (2500, 7);
+   for (int i = 0; i < 2500; ++i) {
+       x[i] = 2500 - i;
+   }
+   std::sort(x.begin(), x.end());
+   const MyTieredDeque<int>& c = x;
+   for (MyTieredDeque<int>::const_iterator b = c.begin(); b != c.end(); ++b) {
+       ASSERT_EQ(*b, (b - c.begin()) + 1);
+   }
+   MyTieredDeque<int> y(x);
+   ASSERT_TRUE(x == y);
+   y.back() = 0;
+   ASSERT_TRUE(y < x);
+   ASSERT_THROW(c.at(2500), out_of_range);
+   x.resize(3);
+   ASSERT_EQ(x.size(), 3);
+   x.clear();
+   ASSERT_TRUE(x.empty());
+   ASSERT_TRUE(x.begin() == x.end());
+ }
+
+    // ---
+    // Soa
+    // ---
+
+ struct segment_sum {
+   long long s;
+   int runs;
+   segment_sum () : s (0), runs (0) {}
+   void operator () (const int* b, const int* e) {
+       ++runs;
+       while (b != e) {
+           s += *b++;
+       }
+   }
+ };
+
+ TEST(Soa, Test1) {
+   soa_deque<int, double, string> x;
+   for (int i = 0; i < 100; ++i) {
+       x.push_back(i, i / 2.0, to_string(i));
+       x.push_front(-i, -i / 2.0, to_string(-i));
+   }
+   ASSERT_EQ(x.size(), 200);
+   ASSERT_EQ(std::get<0>(x.front()), -99);
+   ASSERT_EQ(std::get<2>(x.back()), "99");
+   ASSERT_EQ(std::get<1>(x[150]), 25.0);
+   std::get<2>(x[150]) = "z";
+   ASSERT_EQ(x.field<2>()[150], "z");
+   x.pop_front();
+   x.pop_back();
+   ASSERT_EQ(x.size(), 198);
+   ASSERT_EQ(x.field<0>().size(), 198);
+   ASSERT_EQ(std::get<0>(x.front()), -98);
+ }
+
+ TEST(Soa, Test2) {
+   soa_deque<int, char> x;
+   for (int i = 0; i < 95; ++i) {
+       x.push_front(i, 'a');
+   }
+   segment_sum f = x.for_each_segment<0>(segment_sum());
+   ASSERT_EQ(f.s, 95 * 94 / 2);
+   ASSERT_GE(f.runs, 95 / BLOCK_WIDTH);
+   int n = 0;
+   for (soa_deque<int, char>::iterator b = x.begin(); b != x.end(); ++b) {
+       std::get<1>(*b) = 'b';
+       ++n;
+   }
+   ASSERT_EQ(n, 95);
+   const soa_deque<int, char>& c = x;
+   soa_deque<int, char>::const_iterator p = c.begin() + 10;
+   ASSERT_EQ(std::get<0>(*p), 84);
+   ASSERT_EQ(std::get<1>(p[3]), 'b');
+   ASSERT_EQ(c.end() - p, 85);
+ }
+
+ TEST(Soa, Test3) {
+   soa_deque<int, string> x;
+   x.resize(30, std::make_tuple(1, string("a")));
+   soa_deque<int, string> y(x);
+   ASSERT_TRUE(x == y);
+   std::get<0>(y[29]) = 2;
+   ASSERT_FALSE(x == y);
+   x.swap(y);
+   ASSERT_EQ(std::get<0>(x[29]), 2);
+   x.clear();
+   ASSERT_TRUE(x.empty());
+   ASSERT_EQ(y.size(), 30);
+ }
+
+    // --------
+    // HugePage
+    // --------
+
+ TEST(HugePage, Test1) {
+   huge_page_allocator<string> a;
+   MyDeque<string, huge_page_allocator<string> > x(a);
+   deque<string> y;
+   for (int i = 0; i < 5000; ++i) {
+       x.push_back(to_string(i));
+       y.push_back(to_string(i));
+       if (i % 3 == 0) {
+           x.push_front(to_string(-i));
+           y.push_front(to_string(-i));
+       }
+       if (i % 7 == 0) {
+           x.pop_back();
+           y.pop_back();
+       }
+   }
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+   ASSERT_GE(a.arena().regions(), 1);
+   MyDeque<string, huge_page_allocator<string> > z(x);
+   ASSERT_TRUE(z == x);
+ }
+
+ TEST(HugePage, Test2) {
+   huge_page_allocator<int> a(true);
+   MyDeque<int, huge_page_allocator<int> > x(a);
+   MyDeque<int, huge_page_allocator<int> > y(a);
+   x.push_back(1);
+   y.push_back(2);
+   y.push_back(3);
+   x.swap(y);
+   ASSERT_EQ(x.size(), 2);
+   ASSERT_EQ(y[0], 1);
+   const int* p = &x[0];
+   x.splice_back(std::move(y));
+   ASSERT_EQ(x.size(), 3);
+   ASSERT_EQ(&x[0], p);
+ }
+
+    // -------
+    // Aligned
+    // -------
+
+ struct segment_alignment {
+   int runs;
+   int aligned;
+   segment_alignment () : runs (0), aligned (0) {}
+   void operator () (const double* b, const double*) {
+       ++runs;
+       aligned += (reinterpret_cast<size_t>(b) % 64 == 0);
+   }
+ };
+
+ TEST(Aligned, Test1) {
+   MyDeque<double, aligned_allocator<double> > x;
+   for (int i = 0; i < 500; ++i) {
+       x.push_back(i);
+       x.push_front(-i);
+   }
+   const MyDeque<double, aligned_allocator<double> >& c = x;
+   segment_alignment f = c.for_each_segment(segment_alignment());
+   ASSERT_GE(f.runs, 1000 / BLOCK_WIDTH);
+   ASSERT_GE(f.aligned, f.runs - 1);
+   double sum = 0;
+   for (MyDeque<double, aligned_allocator<double> >::const_iterator p = c.begin(); p != c.end(); ++p) {
+       sum += *p;
+   }
+   ASSERT_EQ(sum, 0);
+   ASSERT_EQ(c.front(), -499);
+   ASSERT_EQ(c.back(), 499);
+ }
+
+    // -----------
+    // Relocatable
+    // -----------
+
+ TEST(Relocatable, Test1) {
+   ASSERT_TRUE(is_trivially_relocatable<int>::value);
+   ASSERT_TRUE(is_trivially_relocatable< std::unique_ptr<int> >::value);
+   ASSERT_TRUE(is_trivially_relocatable< std::shared_ptr<int> >::value);
+   ASSERT_FALSE(is_trivially_relocatable<std::string>::value);
+ }
+
+ TEST(Relocatable, Test2) {
+   MyDeque<long>   x;
+   std::deque<long> y;
+   for (long i = 0; i < 300; ++i) {
+       x.push_back(i);
+       y.push_back(i);
+   }
+   for (int i = 0; i < 200; ++i) {
+       int k = (i * 37) % (int) y.size();
+       if (i % 3) {
+           x.insert(x.begin() + k, -i);
+           y.insert(y.begin() + k, -i);
+       }
+       else {
+           ASSERT_EQ(*x.erase(x.begin() + k), *y.erase(y.begin() + k));
+       }
+       ASSERT_EQ(x.size(), y.size());
+   }
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+ }
+
+ TEST(Relocatable, Test3) {
+   std::shared_ptr<int> p(new int(7));
+   {
+   MyDeque< std::shared_ptr<int> > x;
+   for (int i = 0; i < 50; ++i) {
+       x.push_back(std::make_shared<int>(i));
+   }
+   x.insert(x.begin() + 5, p);
+   x.erase(x.begin() + 10);
+   x.erase(x.begin());
+   ASSERT_EQ(x.size(), 49);
+   ASSERT_EQ(*x[0], 1);
+   ASSERT_EQ(x[4], p);
+   ASSERT_EQ(*x[9], 10);
+   ASSERT_EQ(*x.back(), 49);
+   ASSERT_EQ(p.use_count(), 2);
+   }
+   ASSERT_EQ(p.use_count(), 1);
+ }
+
+ TEST(Relocatable, Test4) {
+   MyDeque<std::string> x;
+   for (int i = 0; i < 45; ++i) {
+       x.push_back(std::string(i, 'a'));
+   }
+   x.insert(x.begin() + 3, "b");
+   x.erase(x.begin() + 30);
+   ASSERT_EQ(x.size(), 45);
+   ASSERT_EQ(x[3], "b");
+   ASSERT_EQ(x[4], std::string(3, 'a'));
+   ASSERT_EQ(x[30], std::string(30, 'a'));
+ }
+
+    // -----
+    // Batch
+    // -----
+
+ TEST(Batch, Test1) {
+   MyDeque<int>    x;
+   std::deque<int> y;
+   for (int i = 0; i < 1000; ++i) {
+       x.push_back(i);
+       y.push_back(i);
+   }
+   for (int n = 0; !x.empty(); n = (n * 7 + 3) % 97) {
+       int m = std::min<int>(n, x.size());
+       if (n % 2) {
+           x.pop_front_n(m);
+           y.erase(y.begin(), y.begin() + m);
+       }
+       else {
+           x.pop_back_n(m);
+           y.erase(y.end() - m, y.end());
+       }
+       ASSERT_EQ(x.size(), y.size());
+       ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+       x.push_back(n);
+       y.push_back(n);
+       x.pop_front_n(1);
+       y.pop_front();
+   }
+ }
+
+ TEST(Batch, Test2) {
+   MyDeque<std::string> x;
+   for (int i = 0; i < 300; ++i) {
+       x.push_back(std::string(i % 40, 'a' + i % 26));
+   }
+   std::vector<std::string> y;
+   x.drain_front_into(std::back_inserter(y), 256);
+   ASSERT_EQ(y.size(), 256);
+   ASSERT_EQ(x.size(), 44);
+   ASSERT_EQ(y[1], "b");
+   ASSERT_EQ(y[255], std::string(255 % 40, 'a' + 255 % 26));
+   ASSERT_EQ(x.front(), std::string(256 % 40, 'a' + 256 % 26));
+   x.drain_front_into(std::back_inserter(y), 44);
+   ASSERT_TRUE(x.empty());
+   ASSERT_EQ(y.size(), 300);
+ }
+
+ TEST(Batch, Test3) {
+   MyDeque<std::string> x;
+   x.copy_on_write(true);
+   for (int i = 0; i < 100; ++i) {
+       x.push_back(std::string(30, 'a' + i % 26));
+   }
+   MyDeque<std::string> y(x);
+   std::vector<std::string> z;
+   x.drain_front_into(std::back_inserter(z), 50);
+   x.pop_back_n(25);
+   ASSERT_EQ(x.size(), 25);
+   ASSERT_EQ(x.front(), std::string(30, 'a' + 50 % 26));
+   ASSERT_EQ(z[49], std::string(30, 'a' + 49 % 26));
+   ASSERT_EQ(y.size(), 100);
+   for (int i = 0; i < 100; ++i) {
+       ASSERT_EQ(y[i], std::string(30, 'a' + i % 26));
+   }
+ }
+
+// ------
+// bounds
+// ------
+
+// counting_allocator counts the blocks and the maps apart, and counted counts its copies and
+// moves, to hold MyDeque to its complexity bounds
+
+struct counted {
+    static std::size_t copies;
+    static std::size_t moves;
+    static std::size_t assigns; // copies by assignment
+
+    int v;
+
+    counted (int x = 0) :
+            v (x)
+        {}
+
+    counted (const counted& that) :
+            v (that.v) {
+        ++copies;
+    }
+
+    counted (counted&& that) :
+            v (that.v) {
+        ++moves;
+    }
+
+    counted& operator = (const counted& that) {
+        ++copies;
+        ++assigns;
+        v = that.v;
+        return *this;
+    }
+
+    counted& operator = (counted&& that) {
+        ++moves;
+        v = that.v;
+        return *this;
+    }
+
+    static void reset () {
+        copies = moves = assigns = 0;
+    }
+};
+
+std::size_t counted::copies  = 0;
+std::size_t counted::moves   = 0;
+std::size_t counted::assigns = 0;
+
+typedef counting_allocator<counted>  block_counter;
+typedef counting_allocator<counted*> map_counter;
+
+/**
+ * the most times a map of at least m slots can have been allocated, growing from one by doubling
+ */
+std::size_t map_bound (std::size_t m) {
+    std::size_t k = 1;
+    while (m > 1) {
+        m /= 2;
+        ++k;
+    }
+    return k + 1;
+}
+
+ TEST(Bounds, Test1) {
+   const int n = 1 << 16;
+   block_counter::reset();
+   map_counter::reset();
+   counted::reset();
+   {
+       MyDeque< counted, counting_allocator<counted> > x;
+       for (int i = 0; i != n; ++i) {
+           x.push_back(counted(i));
+       }
+       ASSERT_EQ(counted::copies, 0);
+       ASSERT_EQ(counted::moves, n);
+       ASSERT_LE(block_counter::made, 4 * n / BLOCK_WIDTH + 4);
+       ASSERT_LE(map_counter::made, map_bound(n / BLOCK_WIDTH));
+   }
+   ASSERT_EQ(block_counter::made, block_counter::freed);
+   ASSERT_EQ(map_counter::made,   map_counter::freed);
+ }
+
+ TEST(Bounds, Test2) {
+   const int n = 1 << 16;
+   block_counter::reset();
+   map_counter::reset();
+   counted::reset();
+   MyDeque< counted, counting_allocator<counted> > x;
+   for (int i = 0; i != n; ++i) {
+       if (i % 2) {
+           x.push_front(counted(i));
+       }
+       else {
+           x.push_back(counted(i));
+       }
+   }
+   ASSERT_EQ(counted::copies, 0);
+   ASSERT_EQ(counted::moves, n);
+   ASSERT_LE(block_counter::made, 4 * n / BLOCK_WIDTH + 4);
+   ASSERT_LE(map_counter::made, map_bound(n / BLOCK_WIDTH));
+ }
+
+ TEST(Bounds, Test3) {
+   const int depth = 1000;
+   MyDeque< counted, counting_allocator<counted> > x;
+   for (int i = 0; i != depth; ++i) {
+       x.push_back(counted(i));
+   }
+   for (int i = 0; i != 10 * depth; ++i) {
+       x.push_back(counted(i));
+       x.pop_front();
+   }
+   block_counter::reset();
+   map_counter::reset();
+   counted::reset();
+   for (int i = 0; i != 200 * depth; ++i) {
+       x.push_back(counted(i));
+       x.pop_front();
+   }
+   ASSERT_EQ(block_counter::made,   0);
+   ASSERT_EQ(block_counter::freed, 0);
+   ASSERT_EQ(map_counter::made,     0);
+   ASSERT_EQ(counted::copies, 0);
+   ASSERT_EQ(x.size(), depth);
+ }
+
+ TEST(Bounds, Test4) {
+   const int n = 1 << 14;
+   MyDeque< counted, counting_allocator<counted> > x;
+   for (int i = 0; i != n; ++i) {
+       x.push_back(counted(i));
+   }
+   block_counter::reset();
+   map_counter::reset();
+   counted::reset();
+   x.pop_back_n(n / 2);
+   x.pop_front_n(n / 4);
+   x.erase_if([] (const counted& c) {return c.v % 2;});
+   ASSERT_EQ(counted::copies, 0);
+   ASSERT_EQ(block_counter::made, 0);
+   ASSERT_EQ(map_counter::made,   0);
+   ASSERT_EQ(x.size(), n / 8);
+ }
+
+// -------
+// gradual
+// -------
+
+ TEST(Gradual, Test1) {
+   MyDeque<int>    x;
+   std::deque<int> y;
+   ASSERT_FALSE(x.gradual_growth());
+   x.gradual_growth(true);
+   ASSERT_TRUE(x.gradual_growth());
+   for (int i = 0; i != 200000; ++i) {
+       if (i % 3) {
+           x.push_back(i);
+           y.push_back(i);
+       }
+       else {
+           x.push_front(i);
+           y.push_front(i);
+       }
+       if (i % 7 == 0) {
+           x.pop_back();
+           y.pop_back();
+       }
+   }
+   ASSERT_EQ(x.size(), y.size());
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+   x.gradual_growth(false);
+   ASSERT_FALSE(x.gradual_growth());
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+ }
+
+ TEST(Gradual, Test2) {
+   const int depth = 50000;
+   MyDeque< counted, counting_allocator<counted> > x;
+   x.gradual_growth(true);
+   for (int i = 0; i != depth; ++i) {
+       x.push_back(counted(i));
+   }
+   for (int i = 0; i != 10 * depth; ++i) {
+       x.push_back(counted(depth + i));
+       x.pop_front();
+   }
+   block_counter::reset();
+   counted::reset();
+   for (int i = 0; i != 40 * depth; ++i) {
+       x.push_back(counted(11 * depth + i));
+       x.pop_front();
+   }
+   ASSERT_EQ(block_counter::made,  0);
+   ASSERT_EQ(block_counter::freed, 0);
+   ASSERT_EQ(counted::copies, 0);
+   ASSERT_EQ(x.size(), depth);
+   ASSERT_EQ(x.front().v, 11 * depth + 39 * depth);
+   ASSERT_EQ(x.back().v,  11 * depth + 40 * depth - 1);
+ }
+
+ TEST(Gradual, Test3) {
+   MyDeque<std::string>    x;
+   std::deque<std::string> y;
+   x.gradual_growth(true);
+   for (int i = 0; i != 100000; ++i) {
+       std::string v(1, 'a' + i % 26);
+       x.push_back(v);
+       y.push_back(v);
+       switch (i % 9973) {
+           case 1000: {
+               MyDeque<std::string> z(x);
+               ASSERT_TRUE(z == x);
+               break;}
+           case 2000:
+               x.resize(x.size() + 100, "r");
+               y.resize(y.size() + 100, "r");
+               break;
+           case 3000: {
+               MyDeque<std::string> z(3, "s");
+               x.splice_back(std::move(z));
+               y.insert(y.end(), 3, "s");
+               break;}
+           case 4000:
+               x.erase_if([] (const std::string& s) {return s == "b";});
+               y.erase(std::remove(y.begin(), y.end(), "b"), y.end());
+               break;
+           case 5000:
+               x.insert(x.begin() + 7, "i");
+               y.insert(y.begin() + 7, "i");
+               break;
+       }
+   }
+   ASSERT_EQ(x.size(), y.size());
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+   x.clear();
+   ASSERT_TRUE(x.empty());
+ }
+
+ TEST(Gradual, Test4) {
+   for (int n = 100; n < 20000; n += 97) {
+       MyDeque<int> x;
+       x.gradual_growth(true);
+       x.copy_on_write(true);
+       for (int i = 0; i != n; ++i) {
+           x.push_back(i);
+       }
+       MyDeque<int> y(x);
+       for (int i = 0; i != n; ++i) {
+           x.push_front(-i);
+           x.pop_back();
+       }
+       ASSERT_EQ(x.size(), n);
+       ASSERT_EQ(y.size(), n);
+       for (int i = 0; i != n; ++i) {
+           ASSERT_EQ(x[i], i + 1 - n);
+           ASSERT_EQ(y[i], i);
+       }
+   }
+ }
+
+ TEST(Gradual, Test5) {
+   block_counter::reset();
+   map_counter::reset();
+   for (int n = 1; n != 200; ++n) {
+       MyDeque< counted, counting_allocator<counted> > x;
+       MyDeque< counted, counting_allocator<counted> > y;
+       x.gradual_growth(true);
+       y.gradual_growth(true);
+       for (int i = 0; i != n * BLOCK_WIDTH + 7; ++i) {
+           x.push_back(counted(i));
+       }
+       for (int i = 0; i != 60 * BLOCK_WIDTH; ++i) {
+           y.push_back(counted(i - 7));
+       }
+       y.pop_front_n(7);
+       x.splice_back(std::move(y));
+       ASSERT_EQ(x.back().v, 60 * BLOCK_WIDTH - 8);
+       ASSERT_EQ(x.size(), (n + 60) * BLOCK_WIDTH);
+       for (int i = 0; i != 1000; ++i) {
+           x.push_back(counted(i));
+       }
+       ASSERT_EQ(x[n * BLOCK_WIDTH].v, n * BLOCK_WIDTH);
+       ASSERT_EQ(x[n * BLOCK_WIDTH + 7].v, 0);
+       ASSERT_TRUE(y.empty());
+   }
+   ASSERT_EQ(block_counter::made, block_counter::freed);
+   ASSERT_EQ(map_counter::made,   map_counter::freed);
+ }
+
+// ------
+// assign
+// ------
+
+ TEST(Assign, Test1) {
+   MyDeque<int>    x;
+   std::deque<int> y;
+   const int sizes[] = {0, 7, 300, 45, 45, 2000, 1, 0, 64, 999};
+   for (int i = 0; i != 10; ++i) {
+       std::vector<int> v(sizes[i]);
+       for (int j = 0; j != sizes[i]; ++j) {
+           v[j] = i * 10000 + j;
+       }
+       if (i % 2) {
+           x.assign(v.begin(), v.end());
+           y.assign(v.begin(), v.end());
+       }
+       else {
+           x.assign(sizes[i], i);
+           y.assign(sizes[i], i);
+       }
+       ASSERT_EQ(x.size(), y.size());
+       ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+       x.pop_front_n(x.size() / 3);
+       y.erase(y.begin(), y.begin() + y.size() / 3);
+   }
+   x.assign(3, 5);
+   ASSERT_EQ(x.size(), 3);
+   ASSERT_EQ(x.back(), 5);
+   x.assign(4, x[1]);
+   ASSERT_EQ(x.size(), 4);
+   ASSERT_EQ(x.front(), 5);
+ }
+
+ TEST(Assign, Test2) {
+   const int n = 5000;
+   MyDeque< counted, counting_allocator<counted> > x;
+   MyDeque< counted, counting_allocator<counted> > y;
+   for (int i = 0; i != n; ++i) {
+       x.push_back(counted(i));
+       y.push_back(counted(-i));
+   }
+   block_counter::reset();
+   map_counter::reset();
+   counted::reset();
+   for (int i = 0; i != 100; ++i) {
+       y = x;
+       y.front().v = i;
+   }
+   ASSERT_EQ(block_counter::made, 0);
+   ASSERT_EQ(map_counter::made,   0);
+   ASSERT_EQ(counted::copies,  100 * n);
+   ASSERT_EQ(counted::assigns, 100 * n);
+   ASSERT_EQ(y.back().v, n - 1);
+ }
+
+ TEST(Assign, Test3) {
+   const int n = 1000;
+   MyDeque< counted, counting_allocator<counted> > x;
+   MyDeque< counted, counting_allocator<counted> > y;
+   for (int i = 0; i != n; ++i) {
+       x.push_back(counted(i));
+       y.push_back(counted(-i));
+   }
+   y.pop_front_n(9 * n / 10);
+   block_counter::reset();
+   map_counter::reset();
+   counted::reset();
+   y = x;
+   ASSERT_EQ(block_counter::made, 0);
+   ASSERT_EQ(map_counter::made,   0);
+   ASSERT_EQ(counted::copies,  n);
+   ASSERT_EQ(counted::assigns, n / 10);
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin(), [] (const counted& a, const counted& b) {return a.v == b.v;}));
+   counted::reset();
+   x.assign(n / 4, counted(7));
+   ASSERT_EQ(counted::copies,  n / 4 + 1);
+   ASSERT_EQ(counted::assigns, n / 4);
+   ASSERT_EQ(block_counter::made, 0);
+   ASSERT_EQ(x.size(), n / 4);
+ }
+
+ TEST(Assign, Test4) {
+   MyDeque<int> x(10, overwrite_oldest);
+   MyDeque<int> y(20, 1);
+   ASSERT_THROW(x.assign(11, 0), length_error);
+   ASSERT_THROW(x = y, length_error);
+   x.assign(10, 2);
+   ASSERT_TRUE(x.full());
+   y.resize(10);
+   x = y;
+   ASSERT_TRUE(x == y);
+   y.copy_on_write(true);
+   MyDeque<int> z;
+   z = y;
+   ASSERT_TRUE(z == y);
+   z.push_back(3);
+   ASSERT_EQ(y.size(), 10);
+ }
+
+ TEST(Assign, Test5) {
+   typedef MyDeque<int, counting_allocator<int> > deque_type;
+   deque_type x;
+   deque_type y;
+   x.copy_on_write(true);
+   for (int i = 0; i != 1000; ++i) {
+       x.push_back(i);
+   }
+   for (int i = 0; i != 5000; ++i) {
+       y.push_back(-i);
+   }
+   deque_type z(x);
+   y = x;
+   ASSERT_TRUE(y == x);
+   int n = allocations;
+   for (int i = 0; i != 100; ++i) {
+       y = z;
+       y = x;
+   }
+   ASSERT_EQ(allocations, n);
+   ASSERT_EQ(y.shared_blocks(), x.shared_blocks());
+   ASSERT_FALSE(y.copy_on_write());
+   for (int i = 0; i != 3000; ++i) {
+       y.push_back(i);
+   }
+   ASSERT_LE(allocations - n, 1);
+   y.front() = -1;
+   ASSERT_EQ(x.front(), 0);
+   ASSERT_EQ(z.front(), 0);
+   ASSERT_EQ(y.size(), 4000);
+   ASSERT_EQ(x.size(), 1000);
+   ASSERT_TRUE(std::equal(x.begin() + 1, x.end(), y.begin() + 1));
+ }
+
+// -------
+// compare
+// -------
+
+ TEST(Compare, Test1) {
+   ASSERT_TRUE(is_bitwise_comparable<int>::value);
+   ASSERT_TRUE(is_bitwise_comparable<char*>::value);
+   ASSERT_FALSE(is_bitwise_comparable<double>::value);
+   ASSERT_FALSE(is_bitwise_comparable<std::string>::value);
+   MyDeque<int> x;
+   MyDeque<int> y;
+   ASSERT_TRUE(x == y);
+   ASSERT_FALSE(x < y);
+   for (int i = 0; i != 1000; ++i) {
+       x.push_back(i);
+   }
+   for (int i = 999; i >= 0; --i) {
+       y.push_front(i);
+   }
+   ASSERT_TRUE(x == y);
+   ASSERT_FALSE(x < y);
+   ASSERT_FALSE(y < x);
+   y[777] = -1;
+   ASSERT_FALSE(x == y);
+   ASSERT_TRUE(y < x);
+   ASSERT_FALSE(x < y);
+   y[777] = 777;
+   y.pop_back();
+   ASSERT_FALSE(x == y);
+   ASSERT_TRUE(y < x);
+ }
+
+ TEST(Compare, Test2) {
+   MyDeque<unsigned char> x;
+   for (int i = 0; i != 500; ++i) {
+       x.push_back(static_cast<unsigned char>(i * 7));
+   }
+   MyDeque<unsigned char> y(x);
+   ASSERT_TRUE(x == y);
+   y[300] = 255;
+   ASSERT_FALSE(x == y);
+   ASSERT_EQ(x < y, x[300] < 255);
+   MyDeque<char> a(3, 'a');
+   MyDeque<char> b(3, 'a');
+   b[1] = static_cast<char>(200);
+   ASSERT_EQ(a < b, std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end()));
+   ASSERT_EQ(b < a, std::lexicographical_compare(b.begin(), b.end(), a.begin(), a.end()));
+ }
+
+ TEST(Compare, Test3) {
+   MyDeque<double> x(5, 1.0);
+   x[2] = std::numeric_limits<double>::quiet_NaN();
+   MyDeque<double> y(x);
+   ASSERT_FALSE(x == y);
+   MyDeque<double> z(5, 1.0);
+   z[0] = -0.0;
+   MyDeque<double> w(5, 1.0);
+   w[0] = 0.0;
+   ASSERT_TRUE(z == w);
+ }
+
+ TEST(Compare, Test4) {
+   for (int t = 0; t != 300; ++t) {
+       MyDeque<unsigned short>    x;
+       MyDeque<unsigned short>    y;
+       std::deque<unsigned short> u;
+       std::deque<unsigned short> v;
+       int n = rand() % 200;
+       int m = (rand() % 2) ? n : rand() % 200;
+       for (int i = 0; i != std::max(n, m); ++i) {
+           unsigned short e = rand() % 3;
+           if (i < n) {
+               x.push_front(e);
+               u.push_front(e);
+           }
+           if (i < m) {
+               y.push_front(e);
+               v.push_front(e);
+           }
+       }
+       if (n && rand() % 2) {
+           x.pop_back();
+           u.pop_back();
+       }
+       ASSERT_EQ(x == y, u == v);
+       ASSERT_EQ(x <  y, u <  v);
+       ASSERT_EQ(y <  x, v <  u);
+   }
+ }
+
+// -------
+// compact
+// -------
+
+ TEST(Compact, Test1) {
+   MyDeque<int>    x;
+   std::deque<int> y;
+   for (int i = 0; i != 500; ++i) {
+       x.push_back(i);
+       y.push_back(i);
+   }
+   MyDeque<int>::iterator p = x.erase(x.begin() + 10, x.begin() + 50);
+   y.erase(y.begin() + 10, y.begin() + 50);
+   ASSERT_EQ(*p, 50);
+   p = x.erase(x.begin() + 400, x.begin() + 455);
+   y.erase(y.begin() + 400, y.begin() + 455);
+   ASSERT_EQ(*p, y[400]);
+   p = x.erase(x.begin() + 3, x.begin() + 3);
+   ASSERT_EQ(*p, 3);
+   x.erase(x.begin(), x.begin() + 1);
+   y.erase(y.begin(), y.begin() + 1);
+   ASSERT_EQ(x.size(), y.size());
+   ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+   p = x.erase(x.begin(), x.end());
+   ASSERT_TRUE(x.empty());
+   ASSERT_TRUE(p == x.end());
+ }
+
+ TEST(Compact, Test2) {
+   MyDeque<int> x;
+   ASSERT_EQ(x.erase_if([] (int) {return true;}), 0);
+   for (int i = 0; i != 1000; ++i) {
+       x.push_back(i);
+   }
+   int calls = 0;
+   ASSERT_EQ(x.erase_if([&calls] (int v) {++calls; return v % 3 == 0;}), 334);
+   ASSERT_EQ(calls, 1000);
+   ASSERT_EQ(x.size(), 666);
+   for (int i = 0; i != 666; ++i) {
+       ASSERT_EQ(x[i], i / 2 * 3 + i % 2 + 1);
+   }
+   ASSERT_EQ(x.erase_if([] (int v) {return v < 100;}), 66);
+   ASSERT_EQ(x.front(), 100);
+   ASSERT_EQ(x.erase_if([] (int v) {return v > 900;}), 66);
+   ASSERT_EQ(x.back(), 899);
+   ASSERT_EQ(x.erase_if([] (int v) {return v == 500;}), 1);
+   ASSERT_EQ(x.erase_if([] (int) {return false;}), 0);
+   ASSERT_EQ(x.erase_if([] (int) {return true;}), 533);
+   ASSERT_TRUE(x.empty());
+ }
+
+ TEST(Compact, Test3) {
+   for (int t = 0; t != 200; ++t) {
+       MyDeque<std::string> x;
+       std::deque<std::string> y;
+       int n = rand() % 300;
+       for (int i = 0; i != n; ++i) {
+           std::string v(1 + rand() % 20, 'a' + rand() % 26);
+           if (rand() % 2) {
+               x.push_back(v);
+               y.push_back(v);
+           }
+           else {
+               x.push_front(v);
+               y.push_front(v);
+           }
+       }
+       MyDeque<std::string> z(x);
+       char c = 'a' + rand() % 26;
+       size_t k = x.erase_if([c] (const std::string& v) {return v[0] <= c;});
+       std::deque<std::string>::iterator e = std::remove_if(y.begin(), y.end(), [c] (const std::string& v) {return v[0] <= c;});
+       ASSERT_EQ(k, static_cast<size_t>(y.end() - e));
+       y.erase(e, y.end());
+       ASSERT_EQ(x.size(), y.size());
+       ASSERT_TRUE(std::equal(x.begin(), x.end(), y.begin()));
+       ASSERT_EQ(z.size(), static_cast<size_t>(n));
+   }
+ }
+
+    // ----
+    // Span
+    // ----
+
+ TEST(Span, Test1) {
+   MyDeque<char> x;
+   x.push_back('<');
+   MyDeque<char>::segment v[8];
+   size_t c = x.acquire_back(50, v, 8);
+   ASSERT_EQ(c, 3);
+   ASSERT_EQ(v[0].length, BLOCK_WIDTH - 1);
+   size_t t = 0;
+   for (size_t k = 0; k != c; ++k) {
+       std::memset(v[k].base, 'a' + k, v[k].length);
+       t += v[k].length;
+   }
+   ASSERT_EQ(t, 50);
+   x.commit_back(45);
+   ASSERT_EQ(x.size(), 46);
+   ASSERT_EQ(x[0], '<');
+   ASSERT_EQ(x[1], 'a');
+   ASSERT_EQ(x[BLOCK_WIDTH], 'b');
+   ASSERT_EQ(x.back(), 'c');
+   x.push_back('>');
+   ASSERT_EQ(x[46], '>');
+ }
+
+ TEST(Span, Test2) {
+   MyDeque<int> x;
+   for (int i = 0; i < 100; ++i) {
+       x.push_back(i);
+   }
+   x.pop_front_n(7);
+   MyDeque<int>::const_segment v[2];
+   size_t c = x.peek_front(v, 2);
+   ASSERT_EQ(c, 2);
+   ASSERT_EQ(v[0].length, BLOCK_WIDTH - 7);
+   ASSERT_EQ(v[1].length, BLOCK_WIDTH);
+   ASSERT_EQ(*v[0].base, 7);
+   ASSERT_EQ(*v[1].base, BLOCK_WIDTH);
+   x.consume_front(v[0].length + v[1].length);
+   ASSERT_EQ(x.front(), 2 * BLOCK_WIDTH);
+   MyDeque<int>::const_segment w[10];
+   ASSERT_EQ(x.peek_front(w, 10), 3);
+ }
+
+ TEST(Span, Test3) {
+   MyDeque<int> x;
+   x.copy_on_write(true);
+   x.push_back(1);
+   x.push_back(2);
+   MyDeque<int> y(x);
+   MyDeque<int>::segment v[4];
+   size_t c = x.acquire_back(30, v, 4);
+   for (size_t k = 0; k != c; ++k) {
+       std::fill(v[k].base, v[k].base + v[k].length, 9);
+   }
+   x.commit_back(30);
+   ASSERT_EQ(x.size(), 32);
+   ASSERT_EQ(x[31], 9);
+   ASSERT_EQ(y.size(), 2);
+   ASSERT_EQ(y[1], 2);
+
+   MyDeque<int> z(3, reject_newest);
+   try {
+       z.acquire_back(4, v, 4);
+       ASSERT_TRUE(false);
+   }
+   catch (const std::length_error&) {
+       ASSERT_EQ(z.size(), 0);
+   }
+ }
+
+#ifdef __unix__
+ TEST(Span, Test4) {
+   ASSERT_EQ(sizeof(iovec), sizeof(MyDeque<char>::segment));
+   ASSERT_EQ(offsetof(iovec, iov_len), offsetof(MyDeque<char>::segment, length));
+   int in[2];
+   int out[2];
+   ASSERT_EQ(pipe(in), 0);
+   ASSERT_EQ(pipe(out), 0);
+   std::string s;
+   for (int i = 0; i < 300; ++i) {
+       s += char('a' + i % 26);
+   }
+   ASSERT_EQ(write(in[1], s.data(), s.size()), 300);
+
+   MyDeque<char> x;
+   MyDeque<char>::segment v[32];
+   size_t  c = x.acquire_back(300, v, 32);
+   ssize_t r = readv(in[0], reinterpret_cast<iovec*>(v), c);
+   ASSERT_EQ(r, 300);
+   x.commit_back(r);
+   ASSERT_TRUE(std::equal(s.begin(), s.end(), x.begin()));
+
+   MyDeque<char>::const_segment w[32];
+   c = x.peek_front(w, 32);
+   ssize_t t = writev(out[1], reinterpret_cast<const iovec*>(w), c);
+   ASSERT_EQ(t, 300);
+   x.consume_front(t);
+   ASSERT_TRUE(x.empty());
+   char b[300];
+   ASSERT_EQ(read(out[0], b, 300), 300);
+   ASSERT_EQ(std::string(b, 300), s);
+   close(in[0]);
+   close(in[1]);
+   close(out[0]);
+   close(out[1]);
+ }
+#endif
+
+    // ----------
+    // ByteBuffer
+    // ----------
+
+ TEST(ByteBuffer, Test1) {
+   MyByteBuffer<> x;
+   std::string  s;
+   for (int i = 0; i < 3 * BUFFER_PAGE; ++i) {
+       s += (i % 1000 == 999) ? '\n' : char('a' + i % 26);
+   }
+   x.append(s.data(), 100);
+   x.append(s.data() + 100, s.size() - 100);
+   ASSERT_EQ(x.size(), s.size());
+   ASSERT_EQ(x[BUFFER_PAGE], s[BUFFER_PAGE]);
+   ASSERT_EQ(x.find('\n'), 999);
+   ASSERT_EQ(x.find('\n', 1000), 1999);
+   ASSERT_EQ(x.find('\n', 4000), 4999);
+   ASSERT_EQ(x.find('#'), MyByteBuffer<>::npos);
+   x.consume(4000);
+   ASSERT_EQ(x.find('\n'), 999);
+   const char* p = x.peek_contiguous(50);
+   ASSERT_EQ(std::string(p, 50), s.substr(4000, 50));
+   p = x.peek_contiguous(200);
+   ASSERT_EQ(std::string(p, 200), s.substr(4000, 200));
+   x.clear();
+   ASSERT_TRUE(x.empty());
+   ASSERT_EQ(x.find('a'), MyByteBuffer<>::npos);
+ }
+
+ TEST(ByteBuffer, Test2) {
+   MyByteBuffer<> x;
+   x.append("ab", 2);
+   const char* p = x.peek_contiguous(2);
+   x.consume(1);
+   ASSERT_EQ(x.peek_contiguous(1), p + 1);
+   ASSERT_EQ(x[0], 'b');
+   x.consume(1);
+   ASSERT_TRUE(x.empty());
+   x.append("cd", 2);
+   ASSERT_EQ(x.size(), 2);
+   ASSERT_EQ(x.find('d'), 1);
+ }
+
+#ifdef __unix__
+ TEST(ByteBuffer, Test3) {
+   int in[2];
+   int out[2];
+   ASSERT_EQ(pipe(in), 0);
+   ASSERT_EQ(pipe(out), 0);
+   std::string s;
+   for (int i = 0; i < 10000; ++i) {
+       s += char('a' + i % 26);
+   }
+   ASSERT_EQ(write(in[1], s.data(), s.size()), 10000);
+   MyByteBuffer<> x;
+   x.append("<", 1);
+   ASSERT_EQ(x.read_from(in[0], 6000), 6000);
+   ASSERT_EQ(x.read_from(in[0]), 4000);
+   ASSERT_EQ(x.size(), 10001);
+   x.consume(1);
+   ASSERT_EQ(x.write_to(out[1]), 10000);
+   ASSERT_TRUE(x.empty());
+   std::vector<char> b(10000);
+   ASSERT_EQ(read(out[0], &b[0], b.size()), 10000);
+   ASSERT_TRUE(std::equal(s.begin(), s.end(), b.begin()));
+   close(in[1]);
+   ASSERT_EQ(x.read_from(in[0]), 0);
+   close(in[0]);
+   close(out[0]);
+   close(out[1]);
+ }
+
+ TEST(ByteBuffer, Test4) {
+   int f[2];
+   ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, f), 0);
+   std::string s;
+   for (int i = 0; i < 500; ++i) {
+       s += std::string(i % 37, 'a' + i % 26) + "\r\n";
+   }
+   ASSERT_EQ(write(f[0], s.data(), s.size()), (ssize_t) s.size());
+   close(f[0]);
+   MyByteBuffer<> x;
+   std::vector<std::string> lines;
+   while (x.read_from(f[1], 1000) > 0) {
+       for (size_t k; (k = x.find('\n')) != MyByteBuffer<>::npos; x.consume(k + 1)) {
+           lines.push_back(std::string(x.peek_contiguous(k - 1), k - 1));
+       }
+   }
+   close(f[1]);
+   ASSERT_TRUE(x.empty());
+   ASSERT_EQ(lines.size(), 500);
+   ASSERT_EQ(lines[0], "");
+   ASSERT_EQ(lines[40], std::string(3, 'a' + 40 % 26));
+   ASSERT_EQ(lines[499], std::string(499 % 37, 'a' + 499 % 26));
+ }
+
+ TEST(ByteBuffer, Test5) {
+   typedef counting_allocator<char> page_counter;
+   int f[2];
+   ASSERT_EQ(pipe(f), 0);
+   std::string s(3 * BUFFER_PAGE, 'x');
+   ASSERT_EQ(write(f[1], s.data(), s.size()), (ssize_t) s.size());
+   page_counter::reset();
+   {
+       MyByteBuffer<page_counter> x;
+       page_counter::limit = 2;
+       ASSERT_THROW(x.read_from(f[0], 4 * BUFFER_PAGE), std::bad_alloc);
+       page_counter::limit = 0;
+       ASSERT_TRUE(x.empty());
+       ASSERT_EQ(x.read_from(f[0], 3 * BUFFER_PAGE), 3 * BUFFER_PAGE);
+       ASSERT_EQ(page_counter::made, 3);
+   }
+   ASSERT_EQ(page_counter::made, page_counter::freed);
+   close(f[0]);
+   close(f[1]);
+ }
+#endif
+
+    // ------
+    // Packed
+    // ------
+
+ TEST(Packed, Test1) {
+   MyPackedDeque<long long> x;
+   for (long long i = 0; i < 100000; ++i) {
+       x.push_back(1000000000000LL + i);
+   }
+   ASSERT_EQ(x.size(), 100000);
+   ASSERT_GT(x.frames(), 4900);
+   ASSERT_LT(x.footprint() * 3, x.size() * sizeof(long long));
+   ASSERT_EQ(x.front(), 1000000000000LL);
+   ASSERT_EQ(x[54321], 1000000054321LL);
+   ASSERT_EQ(x.back(), 1000000099999LL);
+   long long i = 1000000000000LL;
+   for (MyPackedDeque<long long>::const_iterator p = x.begin(); p != x.end(); ++p) {
+       ASSERT_EQ(*p, i++);
+   }
+ }
+
+ TEST(Packed, Test2) {
+   MyPackedDeque<long> x(2);
+   std::deque<long>    y;
+   srand(7);
+   for (int n = 0; n < 40000; ++n) {
+       long v = (rand() % 4 == 0) ? (long) rand() * rand() : rand() % 100 - 50;
+       switch (rand() % 5) {
+           case 0:
+           case 1:
+               x.push_back(v);
+               y.push_back(v);
+               break;
+           case 2:
+               x.push_front(v);
+               y.push_front(v);
+               break;
+           case 3:
+               if (!y.empty()) {
+                   x.pop_back();
+                   y.pop_back();
+               }
+               break;
+           default:
+               if (!y.empty()) {
+                   x.pop_front();
+                   y.pop_front();
+               }
+       }
+       ASSERT_EQ(x.size(), y.size());
+       if (n % 97 == 0 && !y.empty()) {
+           size_t k = rand() % y.size();
+           ASSERT_EQ(x[k], y[k]);
+       }
+   }
+   ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+ }
+
+ TEST(Packed, Test3) {
+   MyPackedDeque<signed char> x(1);
+   MyPackedDeque<unsigned int> y(0);
+   for (int i = 0; i < 1000; ++i) {
+       x.push_front((signed char) (i * 37));
+       y.push_back(i % 3 ? 0xFFFFFFF0u + i : i);
+   }
+   for (int i = 0; i < 1000; ++i) {
+       ASSERT_EQ(x[999 - i], (signed char) (i * 37));
+       ASSERT_EQ(y[i], i % 3 ? 0xFFFFFFF0u + i : (unsigned int) i);
+   }
+   MyPackedDeque<signed char> z(x);
+   ASSERT_TRUE(z == x);
+   z.pop_back();
+   ASSERT_FALSE(z == x);
+   z.clear();
+   ASSERT_TRUE(z.empty());
+   z.push_back(5);
+   ASSERT_EQ(z.front(), 5);
+ }
+
+    // ----
+    // Bits
+    // ----
+
+ TEST(Bits, Test1) {
+   MyDeque<bool>    x;
+   std::deque<bool> y;
+   srand(11);
+   for (int n = 0; n < 20000; ++n) {
+       bool v = rand() % 3 == 0;
+       switch (rand() % 4) {
+           case 0:
+               x.push_back(v);
+               y.push_back(v);
+               break;
+           case 1:
+               x.push_front(v);
+               y.push_front(v);
+               break;
+           case 2:
+               if (!y.empty() && rand() % 2) {
+                   x.pop_back();
+                   y.pop_back();
+               }
+               break;
+           default:
+               if (!y.empty() && rand() % 2) {
+                   x.pop_front();
+                   y.pop_front();
+               }
+       }
+       ASSERT_EQ(x.size(), y.size());
+   }
+   ASSERT_TRUE(std::equal(y.begin(), y.end(), x.begin()));
+   x[5] = !x[5];
+   x[6].flip();
+   ASSERT_EQ(x[5], !y[5]);
+   ASSERT_EQ(x[6], !y[6]);
+   x[7] = x[5];
+   ASSERT_EQ(x[7], x[5]);
+ }
+
+ TEST(Bits, Test2) {
+   MyDeque<bool> x;
+   x.push_back_bits(0xF0F0F0F0F0F0F0F0ULL);
+   x.push_back_bits(0x5, 3);
+   x.push_front_bits(0x3, 2);
+   x.push_front_bits(~0ULL);
+   ASSERT_EQ(x.size(), 64 + 2 + 64 + 3);
+   ASSERT_TRUE(x[0]);
+   ASSERT_TRUE(x[63]);
+   ASSERT_TRUE(x[64]);
+   ASSERT_TRUE(x[65]);
+   ASSERT_FALSE(x[66]);
+   ASSERT_TRUE(x[66 + 4]);
+   ASSERT_TRUE(x[130]);
+   ASSERT_FALSE(x[131]);
+   ASSERT_TRUE(x[132]);
+   ASSERT_EQ(x.popcount(), 64 + 2 + 32 + 2);
+   ASSERT_EQ(x.popcount(60, 70), 4 + 2 + 0 + 0 + 0 + 0);
+   ASSERT_EQ(x.popcount(66, 130), 32);
+   ASSERT_EQ(x.find_first(66), 70);
+   ASSERT_EQ(x.find_first(131), 132);
+   x.resize(131);
+   ASSERT_EQ(x.find_first(131), 131);
+   ASSERT_EQ(x.popcount(), 64 + 2 + 32 + 1);
+ }
+
+ TEST(Bits, Test3) {
+   MyDeque<bool> x(10000, false);
+   ASSERT_EQ(x.find_first(), 10000);
+   x[9000] = true;
+   x[3000] = true;
+   ASSERT_EQ(x.find_first(), 3000);
+   ASSERT_EQ(x.find_first(3001), 9000);
+   ASSERT_EQ(x.popcount(0, 10000), 2);
+   ASSERT_EQ(x.popcount(3001, 9000), 0);
+   MyDeque<bool> y(x);
+   y[0] = true;
+   ASSERT_FALSE(x[0]);
+   ASSERT_TRUE(x < y);
+   x.swap(y);
+   ASSERT_TRUE(x[0]);
+   ASSERT_EQ(y.find_first(), 3000);
+ }
+
+// ------
+// sorted
+// ------
+
+ TEST(Sorted, Test1) {
+   MySortedDeque<int> x;
+   ASSERT_TRUE(x.lower_bound(5) == x.end());
+   for (int i = 0; i != 1000; ++i) {
+       x.push_back(2 * i);
+   }
+   ASSERT_EQ(x.lower_index(-1),   0);
+   ASSERT_EQ(x.lower_index(0),    0);
+   ASSERT_EQ(x.upper_index(0),    1);
+   ASSERT_EQ(x.lower_index(501),  251);
+   ASSERT_EQ(x.lower_index(502),  251);
+   ASSERT_EQ(x.upper_index(502),  252);
+   ASSERT_EQ(x.lower_index(1998), 999);
+   ASSERT_EQ(x.lower_index(1999), 1000);
+   ASSERT_EQ(*x.lower_bound(63),  64);
+   ASSERT_TRUE(x.upper_bound(5000) == x.end());
+ }
+
+ TEST(Sorted, Test2) {
+   MySortedDeque<int> x;
+   for (int i = 0; i != 300; ++i) {
+       x.push_back(i / 7);
+   }
+   std::pair<MySortedDeque<int>::const_iterator, MySortedDeque<int>::const_iterator> r = x.equal_range(10);
+   ASSERT_EQ(r.second - r.first, 7);
+   ASSERT_EQ(r.first - x.begin(), 70);
+   ASSERT_EQ(x.expire_before(10), 70);
+   ASSERT_EQ(x.front(), 10);
+   ASSERT_EQ(x.lower_index(10), 0);
+   ASSERT_EQ(x.upper_index(10), 7);
+   ASSERT_EQ(x.lower_index(9), 0);
+   x.pop_front_n(x.size());
+   ASSERT_TRUE(x.empty());
+   x.push_back(3);
+   ASSERT_EQ(x.lower_index(3), 0);
+   ASSERT_EQ(x.upper_index(3), 1);
+ }
+
+ TEST(Sorted, Test3) {
+   MySortedDeque<long long> x;
+   std::deque<long long>    y;
+   long long                t = 0;
+   for (int i = 0; i != 20000; ++i) {
+       t += rand() % 4;
+       x.push_back(t);
+       y.push_back(t);
+       if (rand() % 3 == 0) {
+           size_t n = rand() % 8;
+           n = std::min(n, y.size());
+           x.pop_front_n(n);
+           y.erase(y.begin(), y.begin() + n);
+       }
+       long long k = t - rand() % 64;
+       ASSERT_EQ(x.lower_index(k), std::lower_bound(y.begin(), y.end(), k) - y.begin());
+       ASSERT_EQ(x.upper_index(k), std::upper_bound(y.begin(), y.end(), k) - y.begin());
+   }
+ }
+
+ TEST(Sorted, Test4) {
+   MySortedDeque< int, std::greater<int> > x;
+   for (int i = 100; i != 0; --i) {
+       x.push_back(i);
+   }
+   ASSERT_EQ(x.lower_index(50), 50);
+   ASSERT_EQ(x.upper_index(50), 51);
+   ASSERT_EQ(x.expire_before(90), 10);
+   ASSERT_EQ(x.front(), 90);
+ }
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+// -----
+// async
+// -----
+
+// a coroutine nobody waits on, and a single threaded loop to run them
+
+struct detached {
+    struct promise_type {
+        detached            get_return_object   ()          {return detached();}
+        std::suspend_never  initial_suspend     ()          {return std::suspend_never();}
+        std::suspend_never  final_suspend       () noexcept {return std::suspend_never();}
+        void                return_void         ()          {}
+        void                unhandled_exception ()          {std::terminate();}
+    };
+};
+
+struct event_loop {
+    std::deque< std::coroutine_handle<> > ready;
+
+    struct yield {
+        event_loop* l;
+        bool await_ready   ()                          {return false;}
+        void await_suspend (std::coroutine_handle<> h) {l->ready.push_back(h);}
+        void await_resume  ()                          {}
+    };
+
+    yield next () {
+        yield y = {this};
+        return y;
+    }
+
+    void run () {
+        while (!ready.empty()) {
+            std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            h.resume();
+        }
+    }
+};
+
+detached consume (MyAsyncDeque<int>& q, std::vector<int>& got) {
+    while (std::optional<int> v = co_await q.pop_front()) {
+        got.push_back(*v);
+    }
+}
+
+detached produce (event_loop& l, MyAsyncDeque<int>& q, int b, int e) {
+    for (int i = b; i != e; ++i) {
+        q.push_back(i);
+        co_await l.next();
+    }
+}
+
+detached consume_n (MyAsyncDeque<int>& q, std::size_t n, std::vector< std::vector<int> >& got) {
+    for (;;) {
+        std::vector<int> v = co_await q.pop_front_n(n);
+        got.push_back(v);
+        if (v.empty()) {
+            break;
+        }
+    }
+}
+
+ TEST(Async, Test1) {
+   event_loop                      l;
+   MyAsyncDeque<int>               q;
+   std::vector< std::vector<int> > got(1000);
+   for (int i = 0; i != 1000; ++i) {
+       consume(q, got[i]);
+   }
+   ASSERT_EQ(q.waiting(), 1000);
+   produce(l, q, 0, 5000);
+   produce(l, q, 5000, 10000);
+   l.run();
+   ASSERT_EQ(q.waiting(), 1000);
+   ASSERT_TRUE(q.empty());
+   q.close();
+   ASSERT_EQ(q.waiting(), 0);
+   std::vector<int> all;
+   for (int i = 0; i != 1000; ++i) {
+       all.insert(all.end(), got[i].begin(), got[i].end());
+   }
+   std::sort(all.begin(), all.end());
+   ASSERT_EQ(all.size(), 10000);
+   for (int i = 0; i != 10000; ++i) {
+       ASSERT_EQ(all[i], i);
+   }
+ }
+
+ TEST(Async, Test2) {
+   MyAsyncDeque<int> q;
+   std::vector<int>  a;
+   std::vector<int>  b;
+   consume(q, a);
+   consume(q, b);
+   q.push_back(1);
+   q.push_back(2);
+   q.push_back(3);
+   ASSERT_EQ(a, std::vector<int>({1, 3}));
+   ASSERT_EQ(b, std::vector<int>({2}));
+   ASSERT_EQ(q.waiting(), 2);
+   q.close();
+   ASSERT_FALSE(q.push_back(4));
+   ASSERT_EQ(q.waiting(), 0);
+   ASSERT_TRUE(q.closed());
+ }
+
+ TEST(Async, Test3) {
+   MyAsyncDeque<int>               q;
+   std::vector< std::vector<int> > got;
+   consume_n(q, 4, got);
+   for (int i = 0; i != 3; ++i) {
+       q.push_back(i);
+   }
+   ASSERT_TRUE(got.empty());
+   ASSERT_EQ(q.size(), 3);
+   for (int i = 3; i != 10; ++i) {
+       q.push_back(i);
+   }
+   ASSERT_EQ(got.size(), 2);
+   ASSERT_EQ(got[0], std::vector<int>({0, 1, 2, 3}));
+   ASSERT_EQ(got[1], std::vector<int>({4, 5, 6, 7}));
+   ASSERT_EQ(q.size(), 2);
+   q.close();
+   ASSERT_EQ(got.size(), 4);
+   ASSERT_EQ(got[2], std::vector<int>({8, 9}));
+   ASSERT_TRUE(got[3].empty());
+ }
+
+ TEST(Async, Test4) {
+   MyAsyncDeque<std::string> q;
+   q.push_back("a");
+   q.push_back("b");
+   std::optional<std::string> r;
+   [] (MyAsyncDeque<std::string>& q, std::optional<std::string>& r) -> detached {
+       r = co_await q.pop_front();
+   } (q, r);
+   ASSERT_EQ(*r, "a");
+   q.cancel();
+   ASSERT_TRUE(q.empty());
+   r = "x";
+   [] (MyAsyncDeque<std::string>& q, std::optional<std::string>& r) -> detached {
+       r = co_await q.pop_front();
+   } (q, r);
+   ASSERT_FALSE(r);
+ }
+#endif
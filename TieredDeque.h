@@ -0,0 +1,1454 @@
+// -----------------------------
+// projects/deque/TieredDeque.h
+// -----------------------------
+
+#ifndef TieredDeque_h
+#define TieredDeque_h
+#define TIER_WIDTH 1024
+
+// --------
+// includes
+// --------
+
+#include <algorithm> // equal, lexicographical_compare, swap
+#include <cassert>   // assert
+#include <cstring>   // memmove
+#include <iterator>  // random_access_iterator_tag
+#include <memory>    // allocator, allocator_traits
+#include <stdexcept> // out_of_range
+#include <utility>   // move
+#include <vector>    // vector
+
+#include "Deque.h"   // is_trivially_relocatable
+
+// -------------
+// MyTieredDeque
+// -------------
+
+/**
+ * a MyDeque for long sequences edited in the middle
+ *
+ * Blocks hold up to TIER_WIDTH elements and may be partly filled, so an insert or erase only
+ * shifts elements inside one block. A full block is split in two, and a block that falls under a
+ * quarter full is merged with a neighbor. A Fenwick tree over the block sizes finds the block
+ * holding an index in O(log n), and the empty slots ahead of the first block let push_front
+ * add blocks without renumbering the tree.
+ */
+template < typename T, typename A = std::allocator<T> >
+class MyTieredDeque {
+    public:
+        // --------
+        // typedefs
+        // --------
+
+        typedef A                                                   allocator_type;
+        typedef typename allocator_type::value_type                 value_type;
+
+        typedef typename allocator_type::size_type                  size_type;
+        typedef typename allocator_type::difference_type            difference_type;
+
+        typedef std::allocator_traits<allocator_type>               traits_type;
+
+        typedef typename traits_type::pointer                       pointer;
+        typedef typename traits_type::const_pointer                 const_pointer;
+
+        typedef value_type&                                         reference;
+        typedef const value_type&                                   const_reference;
+
+    private:
+        struct block {
+            pointer   d;    // TIER_WIDTH slots, 0 for an empty slot ahead of the first block
+            size_type b;    // first element
+            size_type e;    // one past the last element
+
+            block (pointer x, size_type y, size_type z) :
+                    d (x), b (y), e (z)
+                {}
+
+            size_type size () const {
+                return e - b;
+            }
+        };
+
+        typedef typename traits_type::template rebind_alloc<block>         m_allocator_type;
+        typedef typename traits_type::template rebind_alloc<size_type>     t_allocator_type;
+        typedef std::vector<block, m_allocator_type>                       map_type;
+        typedef std::vector<size_type, t_allocator_type>                   tree_type;
+
+    public:
+        // -----------
+        // operator ==
+        // -----------
+
+        /**
+         * @param lhs a MyTieredDeque reference
+         * @param rhs a MyTieredDeque reference
+         * @return a bool
+         * checks if two MyTieredDeque objects are equal to each other
+         */
+        friend bool operator == (const MyTieredDeque& lhs, const MyTieredDeque& rhs) {
+            return (lhs.size() == rhs.size()) && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+        }
+
+        // ----------
+        // operator <
+        // ----------
+
+        /**
+         * @param lhs a MyTieredDeque reference
+         * @param rhs a MyTieredDeque reference
+         * @return a bool
+         * checks if a MyTieredDeque object is less than the other
+         */
+        friend bool operator < (const MyTieredDeque& lhs, const MyTieredDeque& rhs) {
+            return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+
+    private:
+        // ----
+        // data
+        // ----
+
+        allocator_type _a;
+
+        map_type  _m;       // blocks, in order
+        tree_type _t;       // Fenwick tree over the block sizes, 1-based
+        size_type _f;       // empty slots ahead of the first block
+        size_type _s;       // number of elements
+        pointer   _spare;   // last block given up, kept for the next one needed
+
+    private:
+        // -----
+        // valid
+        // -----
+
+        bool valid () const {
+            return (_f <= _m.size()) && (_t.size() == _m.size() + 1) && (_s == prefix(_m.size()));
+        }
+
+        // ------
+        // prefix
+        // ------
+
+        /**
+         * @param k a size_type
+         * @return a size_type
+         * gives the number of elements in the blocks before slot k
+         */
+        size_type prefix (size_type k) const {
+            size_type s = 0;
+            while (k) {
+                s += _t[k];
+                k -= k & -k;
+            }
+            return s;
+        }
+
+        // ---
+        // add
+        // ---
+
+        /**
+         * @param k a size_type
+         * @param d a difference_type
+         * changes the size of slot k in the tree by d
+         */
+        void add (size_type k, difference_type d) {
+            for (size_type i = k + 1; i < _t.size(); i += i & -i) {
+                _t[i] += d;
+            }
+        }
+
+        // -------
+        // rebuild
+        // -------
+
+        /**
+         * builds the tree over the slots again, in linear time
+         */
+        void rebuild () {
+            size_type n = _m.size();
+            _t.assign(n + 1, 0);
+            for (size_type i = 1; i <= n; ++i) {
+                _t[i] += _m[i - 1].size();
+                size_type j = i + (i & -i);
+                if (j <= n) {
+                    _t[j] += _t[i];
+                }
+            }
+        }
+
+        // ------
+        // locate
+        // ------
+
+        /**
+         * @param index a size_type, less than size()
+         * @param k a size_type reference, set to the slot holding index
+         * @param j a size_type reference, set to the offset of index in that block
+         */
+        void locate (size_type index, size_type& k, size_type& j) const {
+            size_type n    = _m.size();
+            size_type step = 1;
+            while (2 * step <= n) {
+                step *= 2;
+            }
+            k = 0;
+            while (step) {
+                if (k + step <= n && _t[k + step] <= index) {
+                    k += step;
+                    index -= _t[k];
+                }
+                step /= 2;
+            }
+            j = index;
+        }
+
+        // ----------
+        // take_block
+        // ----------
+
+        /**
+         * @return a pointer to TIER_WIDTH slots, the spare block if there is one
+         */
+        pointer take_block () {
+            if (_spare) {
+                pointer x = _spare;
+                _spare = 0;
+                return x;
+            }
+            return _a.allocate(TIER_WIDTH);
+        }
+
+        // ----------
+        // give_block
+        // ----------
+
+        /**
+         * @param x a pointer to TIER_WIDTH slots holding no elements
+         * keeps x as the spare block, or frees it if there already is one
+         */
+        void give_block (pointer x) {
+            if (_spare) {
+                _a.deallocate(x, TIER_WIDTH);
+            }
+            else {
+                _spare = x;
+            }
+        }
+
+        // --------
+        // relocate
+        // --------
+
+        /**
+         * @param to a pointer to the first of n slots
+         * @param from a pointer to n elements
+         * @param n a size_type
+         * moves n elements from from to to, which may overlap, leaving the slots only from covers empty
+         * trivially relocatable elements are moved with one memmove
+         */
+        void relocate (pointer to, pointer from, size_type n) {
+            if (is_trivially_relocatable<T>::value) {
+                std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            }
+            else if (to < from) {
+                for (size_type p = 0; p != n; ++p) {
+                    traits_type::construct(_a, to + p, std::move(from[p]));
+                    traits_type::destroy(_a, from + p);
+                }
+            }
+            else {
+                for (size_type p = n; p != 0; --p) {
+                    traits_type::construct(_a, to + p - 1, std::move(from[p - 1]));
+                    traits_type::destroy(_a, from + p - 1);
+                }
+            }
+        }
+
+        // ----
+        // open
+        // ----
+
+        /**
+         * @param k a size_type, a slot whose block isn't full
+         * @param j a size_type
+         * @return a pointer to an empty slot where the element at offset j of block k now goes
+         * shifts whichever side of j is shorter and has room
+         */
+        pointer open (size_type k, size_type j) {
+            block& x = _m[k];
+            if (x.e != TIER_WIDTH && (x.b == 0 || 2 * j >= x.size())) {
+                relocate(x.d + x.b + j + 1, x.d + x.b + j, x.size() - j);
+                ++x.e;
+            }
+            else {
+                relocate(x.d + x.b - 1, x.d + x.b, j);
+                --x.b;
+            }
+            add(k, 1);
+            return x.d + x.b + j;
+        }
+
+        // -----
+        // close
+        // -----
+
+        /**
+         * @param k a size_type
+         * @param j a size_type
+         * destroys the element at offset j of block k and closes the gap from the shorter side
+         */
+        void close (size_type k, size_type j) {
+            block& x = _m[k];
+            traits_type::destroy(_a, x.d + x.b + j);
+            if (2 * j < x.size()) {
+                relocate(x.d + x.b + 1, x.d + x.b, j);
+                ++x.b;
+            }
+            else {
+                relocate(x.d + x.b + j, x.d + x.b + j + 1, x.size() - j - 1);
+                --x.e;
+            }
+            add(k, -1);
+        }
+
+        // -----
+        // split
+        // -----
+
+        /**
+         * @param k a size_type, a slot whose block is full
+         * moves the back half of block k into a new block right after it
+         */
+        void split (size_type k) {
+            pointer   y = take_block();
+            size_type h = _m[k].b + _m[k].size() / 2;
+            size_type n = _m[k].e - h;
+            relocate(y, _m[k].d + h, n);
+            _m[k].e = h;
+            _m.insert(_m.begin() + k + 1, block(y, 0, n));
+            rebuild();
+        }
+
+        // -----
+        // merge
+        // -----
+
+        /**
+         * @param k a size_type, a slot followed by another block
+         * moves the elements of the block after slot k onto the end of block k and drops that block
+         */
+        void merge (size_type k) {
+            block& x = _m[k];
+            block& y = _m[k + 1];
+            assert(x.size() + y.size() <= TIER_WIDTH);
+            if (TIER_WIDTH - x.e < y.size()) {
+                relocate(x.d, x.d + x.b, x.size());
+                x.e = x.size();
+                x.b = 0;
+            }
+            relocate(x.d + x.e, y.d + y.b, y.size());
+            x.e += y.size();
+            give_block(y.d);
+            _m.erase(_m.begin() + k + 1);
+            rebuild();
+        }
+
+        // ------
+        // settle
+        // ------
+
+        /**
+         * @param k a size_type, a slot that just lost an element
+         * drops block k if it is empty, or merges it with a neighbor if it is under a quarter full
+         * and the two fit in half a block
+         */
+        void settle (size_type k) {
+            if (_m[k].size() == 0) {
+                give_block(_m[k].d);
+                if (k == _f) {
+                    _m[k] = block(0, 0, 0);
+                    ++_f;
+                    if (_f == _m.size()) {
+                        _m.clear();
+                        _t.assign(1, 0);
+                        _f = 0;
+                    }
+                }
+                else if (k == _m.size() - 1) {
+                    _m.pop_back();
+                    _t.pop_back();
+                }
+                else {
+                    _m.erase(_m.begin() + k);
+                    rebuild();
+                }
+                return;
+            }
+            if (4 * _m[k].size() >= TIER_WIDTH) {
+                return;
+            }
+            if (k + 1 < _m.size() && 2 * (_m[k].size() + _m[k + 1].size()) <= TIER_WIDTH) {
+                merge(k);
+            }
+            else if (k > _f && 2 * (_m[k - 1].size() + _m[k].size()) <= TIER_WIDTH) {
+                merge(k - 1);
+            }
+        }
+
+        // ------------
+        // append_block
+        // ------------
+
+        /**
+         * adds an empty block after the last one, filled from its start
+         */
+        void append_block () {
+            _m.push_back(block(take_block(), 0, 0));
+            size_type n = _m.size();
+            _t.push_back(prefix(n - 1) - prefix(n - (n & -n)));
+        }
+
+        // -------------
+        // prepend_block
+        // -------------
+
+        /**
+         * adds an empty block before the first one, filled from its end
+         * when there are no empty slots left ahead of it, as many as there are blocks are made
+         */
+        void prepend_block () {
+            pointer y = take_block();
+            if (!_f) {
+                size_type n = std::max(_m.size(), size_type(1));
+                _m.insert(_m.begin(), n, block(0, 0, 0));
+                _f = n;
+                rebuild();
+            }
+            --_f;
+            _m[_f] = block(y, TIER_WIDTH, TIER_WIDTH);
+        }
+
+    public:
+        // --------
+        // iterator
+        // --------
+
+        class iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::random_access_iterator_tag        iterator_category;
+                typedef typename MyTieredDeque::value_type      value_type;
+                typedef typename MyTieredDeque::difference_type difference_type;
+                typedef typename MyTieredDeque::pointer         pointer;
+                typedef typename MyTieredDeque::reference       reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a bool
+                 * checks to see if two iterators are equal to each other
+                 */
+                friend bool operator == (const iterator& lhs, const iterator& rhs) {
+                    return (lhs.k == rhs.k) && (lhs.j == rhs.j);
+                }
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a bool
+                 * checks to see if two iterators are not equal to each other
+                 */
+                friend bool operator != (const iterator& lhs, const iterator& rhs) {
+                    return !(lhs == rhs);
+                }
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * @param lhs an iterator
+                 * @param rhs a difference_type
+                 * @return an iterator
+                 * increments an iterator by rhs
+                 */
+                friend iterator operator + (iterator lhs, difference_type rhs) {
+                    return lhs += rhs;
+                }
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * @param lhs an iterator
+                 * @param rhs a difference_type
+                 * @return an iterator
+                 * decrements an iterator by rhs
+                 */
+                friend iterator operator - (iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;
+                }
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a difference_type
+                 * gives the number of elements between two iterators
+                 */
+                friend difference_type operator - (const iterator& lhs, const iterator& rhs) {
+                    return lhs.position() - rhs.position();
+                }
+
+                // ----------
+                // operator <
+                // ----------
+
+                /**
+                 * @param lhs an iterator reference
+                 * @param rhs an iterator reference
+                 * @return a bool
+                 * checks to see if lhs comes before rhs
+                 */
+                friend bool operator < (const iterator& lhs, const iterator& rhs) {
+                    return (lhs.k < rhs.k) || ((lhs.k == rhs.k) && (lhs.j < rhs.j));
+                }
+
+            private:
+                // ----
+                // data
+                // ----
+
+                MyTieredDeque* p;
+                size_type      k;   // slot of the block
+                size_type      j;   // offset in the block
+
+            private:
+                // -----
+                // valid
+                // -----
+
+                bool valid () const {
+                    return (k < p->_m.size() && j < p->_m[k].size()) || (k == p->_m.size() && j == 0);
+                }
+
+                // --------
+                // position
+                // --------
+
+                /**
+                 * @return a difference_type
+                 * gives the index of the element pointed to
+                 */
+                difference_type position () const {
+                    return p->prefix(k) + j;
+                }
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param x a MyTieredDeque pointer
+                 * @param y a size_type
+                 * @param z a size_type
+                 * @return a new iterator
+                 * constructs a new iterator pointing to offset z of the block in slot y
+                 */
+                iterator (MyTieredDeque* x, size_type y, size_type z) :
+                        p (x), k (y), j (z) {
+                    assert(valid());
+                }
+
+                // Default copy, destructor, and copy assignment.
+                // iterator (const iterator&);
+                // ~iterator ();
+                // iterator& operator = (const iterator&);
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return a reference to the element being pointed to
+                 */
+                reference operator * () const {
+                    return p->_m[k].d[p->_m[k].b + j];
+                }
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return a pointer to an element
+                 */
+                pointer operator -> () const {
+                    return &**this;
+                }
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * @return an iterator reference
+                 * increments an iterator by one
+                 */
+                iterator& operator ++ () {
+                    if (++j == p->_m[k].size()) {
+                        ++k;
+                        j = 0;
+                    }
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return an iterator
+                 * gives a copy of an iterator and increments the original by one
+                 */
+                iterator operator ++ (int) {
+                    iterator x = *this;
+                    ++(*this);
+                    return x;
+                }
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * @return an iterator reference
+                 * decrements an iterator by one
+                 */
+                iterator& operator -- () {
+                    if (j == 0) {
+                        --k;
+                        j = p->_m[k].size() - 1;
+                    }
+                    else {
+                        --j;
+                    }
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return an iterator
+                 * gives a copy of an iterator and decrements the original by one
+                 */
+                iterator operator -- (int) {
+                    iterator x = *this;
+                    --(*this);
+                    return x;
+                }
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return an iterator reference
+                 * increments an iterator by d, staying in the block when it can
+                 */
+                iterator& operator += (difference_type d) {
+                    difference_type n = j + d;
+                    if (k < p->_m.size() && 0 <= n && n < (difference_type) p->_m[k].size()) {
+                        j = n;
+                    }
+                    else {
+                        *this = p->at_index(position() + d);
+                    }
+                    assert(valid());
+                    return *this;
+                }
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return an iterator reference
+                 * decrements an iterator by d
+                 */
+                iterator& operator -= (difference_type d) {
+                    return *this += -d;
+                }
+
+                // -----------
+                // operator []
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a reference to the element d past the one being pointed to
+                 */
+                reference operator [] (difference_type d) const {
+                    return *(*this + d);
+                }
+
+                friend class MyTieredDeque;
+                friend class const_iterator;
+        };
+
+    public:
+        // --------------
+        // const_iterator
+        // --------------
+
+        class const_iterator {
+            public:
+                // --------
+                // typedefs
+                // --------
+
+                typedef std::random_access_iterator_tag        iterator_category;
+                typedef typename MyTieredDeque::value_type      value_type;
+                typedef typename MyTieredDeque::difference_type difference_type;
+                typedef typename MyTieredDeque::const_pointer   pointer;
+                typedef typename MyTieredDeque::const_reference reference;
+
+            public:
+                // -----------
+                // operator ==
+                // -----------
+
+                /**
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a bool
+                 * checks to see if two const_iterators are equal to each other
+                 */
+                friend bool operator == (const const_iterator& lhs, const const_iterator& rhs) {
+                    return (lhs.k == rhs.k) && (lhs.j == rhs.j);
+                }
+
+                /**
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a bool
+                 * checks to see if two const_iterators are not equal to each other
+                 */
+                friend bool operator != (const const_iterator& lhs, const const_iterator& rhs) {
+                    return !(lhs == rhs);
+                }
+
+                // ----------
+                // operator +
+                // ----------
+
+                /**
+                 * @param lhs a const_iterator
+                 * @param rhs a difference_type
+                 * @return a const_iterator
+                 * increments a const_iterator by rhs
+                 */
+                friend const_iterator operator + (const_iterator lhs, difference_type rhs) {
+                    return lhs += rhs;
+                }
+
+                // ----------
+                // operator -
+                // ----------
+
+                /**
+                 * @param lhs a const_iterator
+                 * @param rhs a difference_type
+                 * @return a const_iterator
+                 * decrements a const_iterator by rhs
+                 */
+                friend const_iterator operator - (const_iterator lhs, difference_type rhs) {
+                    return lhs -= rhs;
+                }
+
+                /**
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a difference_type
+                 * gives the number of elements between two const_iterators
+                 */
+                friend difference_type operator - (const const_iterator& lhs, const const_iterator& rhs) {
+                    return lhs.position() - rhs.position();
+                }
+
+                // ----------
+                // operator <
+                // ----------
+
+                /**
+                 * @param lhs a const_iterator reference
+                 * @param rhs a const_iterator reference
+                 * @return a bool
+                 * checks to see if lhs comes before rhs
+                 */
+                friend bool operator < (const const_iterator& lhs, const const_iterator& rhs) {
+                    return (lhs.k < rhs.k) || ((lhs.k == rhs.k) && (lhs.j < rhs.j));
+                }
+
+            private:
+                // ----
+                // data
+                // ----
+
+                const MyTieredDeque* p;
+                size_type            k;   // slot of the block
+                size_type            j;   // offset in the block
+
+            private:
+                // -----
+                // valid
+                // -----
+
+                bool valid () const {
+                    return (k < p->_m.size() && j < p->_m[k].size()) || (k == p->_m.size() && j == 0);
+                }
+
+                // --------
+                // position
+                // --------
+
+                /**
+                 * @return a difference_type
+                 * gives the index of the element pointed to
+                 */
+                difference_type position () const {
+                    return p->prefix(k) + j;
+                }
+
+            public:
+                // -----------
+                // constructor
+                // -----------
+
+                /**
+                 * @param x a MyTieredDeque pointer
+                 * @param y a size_type
+                 * @param z a size_type
+                 * @return a new const_iterator
+                 * constructs a new const_iterator pointing to offset z of the block in slot y
+                 */
+                const_iterator (const MyTieredDeque* x, size_type y, size_type z) :
+                        p (x), k (y), j (z) {
+                    assert(valid());
+                }
+
+                /**
+                 * @param x an iterator reference
+                 * @return a new const_iterator
+                 * constructs a const_iterator pointing where x points
+                 */
+                const_iterator (const iterator& x) :
+                        p (x.p), k (x.k), j (x.j)
+                    {}
+
+                // Default copy, destructor, and copy assignment.
+                // const_iterator (const const_iterator&);
+                // ~const_iterator ();
+                // const_iterator& operator = (const const_iterator&);
+
+                // ----------
+                // operator *
+                // ----------
+
+                /**
+                 * @return a const_reference to the element being pointed to
+                 */
+                reference operator * () const {
+                    return p->_m[k].d[p->_m[k].b + j];
+                }
+
+                // -----------
+                // operator ->
+                // -----------
+
+                /**
+                 * @return a const_pointer to an element
+                 */
+                pointer operator -> () const {
+                    return &**this;
+                }
+
+                // -----------
+                // operator ++
+                // -----------
+
+                /**
+                 * @return a const_iterator reference
+                 * increments a const_iterator by one
+                 */
+                const_iterator& operator ++ () {
+                    if (++j == p->_m[k].size()) {
+                        ++k;
+                        j = 0;
+                    }
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return a const_iterator
+                 * gives a copy of a const_iterator and increments the original by one
+                 */
+                const_iterator operator ++ (int) {
+                    const_iterator x = *this;
+                    ++(*this);
+                    return x;
+                }
+
+                // -----------
+                // operator --
+                // -----------
+
+                /**
+                 * @return a const_iterator reference
+                 * decrements a const_iterator by one
+                 */
+                const_iterator& operator -- () {
+                    if (j == 0) {
+                        --k;
+                        j = p->_m[k].size() - 1;
+                    }
+                    else {
+                        --j;
+                    }
+                    assert(valid());
+                    return *this;
+                }
+
+                /**
+                 * @return a const_iterator
+                 * gives a copy of a const_iterator and decrements the original by one
+                 */
+                const_iterator operator -- (int) {
+                    const_iterator x = *this;
+                    --(*this);
+                    return x;
+                }
+
+                // -----------
+                // operator +=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a const_iterator reference
+                 * increments a const_iterator by d, staying in the block when it can
+                 */
+                const_iterator& operator += (difference_type d) {
+                    difference_type n = j + d;
+                    if (k < p->_m.size() && 0 <= n && n < (difference_type) p->_m[k].size()) {
+                        j = n;
+                    }
+                    else {
+                        *this = p->at_index(position() + d);
+                    }
+                    assert(valid());
+                    return *this;
+                }
+
+                // -----------
+                // operator -=
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a const_iterator reference
+                 * decrements a const_iterator by d
+                 */
+                const_iterator& operator -= (difference_type d) {
+                    return *this += -d;
+                }
+
+                // -----------
+                // operator []
+                // -----------
+
+                /**
+                 * @param d a difference_type
+                 * @return a const_reference to the element d past the one being pointed to
+                 */
+                reference operator [] (difference_type d) const {
+                    return *(*this + d);
+                }
+        };
+
+    private:
+        // --------
+        // at_index
+        // --------
+
+        /**
+         * @param index a size_type, no more than size()
+         * @return an iterator to the element at index, or end()
+         */
+        iterator at_index (size_type index) {
+            if (index == _s) {
+                return end();
+            }
+            size_type k;
+            size_type j;
+            locate(index, k, j);
+            return iterator(this, k, j);
+        }
+
+        /**
+         * @param index a size_type, no more than size()
+         * @return a const_iterator to the element at index, or end()
+         */
+        const_iterator at_index (size_type index) const {
+            if (index == _s) {
+                return end();
+            }
+            size_type k;
+            size_type j;
+            locate(index, k, j);
+            return const_iterator(this, k, j);
+        }
+
+    public:
+        // ------------
+        // constructors
+        // ------------
+
+        /**
+         * @param a an allocator_type reference
+         * @return a MyTieredDeque object
+         * makes a new empty MyTieredDeque
+         */
+        explicit MyTieredDeque (const allocator_type& a = allocator_type()) :
+                _a (a), _m (m_allocator_type(a)), _t (1, 0, t_allocator_type(a)), _f (0), _s (0), _spare (0) {
+            assert(valid());
+        }
+
+        /**
+         * @param s a size_type
+         * @param v a const_reference
+         * @param a an allocator_type reference
+         * @return a MyTieredDeque object
+         * makes a new MyTieredDeque of size s filled with value v
+         */
+        explicit MyTieredDeque (size_type s, const_reference v = value_type(), const allocator_type& a = allocator_type()) :
+                _a (a), _m (m_allocator_type(a)), _t (1, 0, t_allocator_type(a)), _f (0), _s (0), _spare (0) {
+            resize(s, v);
+            assert(valid());
+        }
+
+        /**
+         * @param that a MyTieredDeque reference
+         * @return a MyTieredDeque object
+         * makes a new MyTieredDeque with the contents of that, in full blocks
+         */
+        MyTieredDeque (const MyTieredDeque& that) :
+                _a (that._a), _m (m_allocator_type(that._a)), _t (1, 0, t_allocator_type(that._a)), _f (0), _s (0), _spare (0) {
+            try {
+                for (const_iterator b = that.begin(); b != that.end(); ++b) {
+                    push_back(*b);
+                }
+            }
+            catch (...) {
+                clear();
+                throw;
+            }
+            assert(valid());
+        }
+
+        /**
+         * @param that a MyTieredDeque rvalue reference
+         * @return a MyTieredDeque object
+         * makes a new MyTieredDeque that takes over the blocks of that
+         */
+        MyTieredDeque (MyTieredDeque&& that) :
+                _a (that._a), _m (m_allocator_type(that._a)), _t (1, 0, t_allocator_type(that._a)), _f (0), _s (0), _spare (0) {
+            swap(that);
+            assert(valid());
+        }
+
+        // ----------
+        // destructor
+        // ----------
+
+        /**
+         * destroys a MyTieredDeque object
+         */
+        ~MyTieredDeque () {
+            clear();
+            if (_spare) {
+                _a.deallocate(_spare, TIER_WIDTH);
+            }
+        }
+
+        // ----------
+        // operator =
+        // ----------
+
+        /**
+         * @param rhs a MyTieredDeque reference
+         * @return a MyTieredDeque reference
+         * assigns the contents of rhs to a MyTieredDeque
+         */
+        MyTieredDeque& operator = (const MyTieredDeque& rhs) {
+            if (this != &rhs) {
+                MyTieredDeque x(rhs);
+                swap(x);
+            }
+            assert(valid());
+            return *this;
+        }
+
+        // -----------
+        // operator []
+        // -----------
+
+        /**
+         * @param index a size_type
+         * @return a reference
+         * gives the element at index, which must be less than size(), in O(log n)
+         */
+        reference operator [] (size_type index) {
+            assert(index < size());
+            size_type k;
+            size_type j;
+            locate(index, k, j);
+            return _m[k].d[_m[k].b + j];
+        }
+
+        /**
+         * @param index a size_type
+         * @return a const_reference
+         * gives the element at index, which must be less than size(), in O(log n)
+         */
+        const_reference operator [] (size_type index) const {
+            assert(index < size());
+            size_type k;
+            size_type j;
+            locate(index, k, j);
+            return _m[k].d[_m[k].b + j];
+        }
+
+        // --
+        // at
+        // --
+
+        /**
+         * @param index a size_type
+         * @return a reference
+         * @throws out_of_range if (index < 0) or (index >= size())
+         * gives the element at index
+         */
+        reference at (size_type index) {
+            if (index >= size()) {
+                throw std::out_of_range("ERROR: invalid index!");
+            }
+            return (*this)[index];
+        }
+
+        /**
+         * @param index a size_type
+         * @return a const_reference
+         * @throws out_of_range if (index < 0) or (index >= size())
+         * gives the element at index
+         */
+        const_reference at (size_type index) const {
+            if (index >= size()) {
+                throw std::out_of_range("ERROR: invalid index!");
+            }
+            return (*this)[index];
+        }
+
+        // ----
+        // back
+        // ----
+
+        /**
+         * @return a reference to the last element
+         */
+        reference back () {
+            assert(!empty());
+            return _m.back().d[_m.back().e - 1];
+        }
+
+        /**
+         * @return a const_reference to the last element
+         */
+        const_reference back () const {
+            assert(!empty());
+            return _m.back().d[_m.back().e - 1];
+        }
+
+        // -----
+        // begin
+        // -----
+
+        /**
+         * @return an iterator to the first element
+         */
+        iterator begin () {
+            return iterator(this, _f, 0);
+        }
+
+        /**
+         * @return a const_iterator to the first element
+         */
+        const_iterator begin () const {
+            return const_iterator(this, _f, 0);
+        }
+
+        // -----
+        // clear
+        // -----
+
+        /**
+         * destroys every element and gives back every block but one
+         */
+        void clear () {
+            for (size_type k = _f; k != _m.size(); ++k) {
+                for (size_type p = _m[k].b; p != _m[k].e; ++p) {
+                    traits_type::destroy(_a, _m[k].d + p);
+                }
+                give_block(_m[k].d);
+            }
+            _m.clear();
+            _t.assign(1, 0);
+            _f = 0;
+            _s = 0;
+            assert(valid());
+        }
+
+        // -----
+        // empty
+        // -----
+
+        /**
+         * @return a bool
+         * checks if a MyTieredDeque holds no elements
+         */
+        bool empty () const {
+            return !_s;
+        }
+
+        // ---
+        // end
+        // ---
+
+        /**
+         * @return an iterator past the last element
+         */
+        iterator end () {
+            return iterator(this, _m.size(), 0);
+        }
+
+        /**
+         * @return a const_iterator past the last element
+         */
+        const_iterator end () const {
+            return const_iterator(this, _m.size(), 0);
+        }
+
+        // -----
+        // erase
+        // -----
+
+        /**
+         * @param p an iterator
+         * @return an iterator to the element after the one removed
+         * removes the element at p, shifting only inside its block
+         */
+        iterator erase (iterator p) {
+            assert(p != end());
+            size_type index = p.position();
+            close(p.k, p.j);
+            --_s;
+            settle(p.k);
+            assert(valid());
+            return at_index(index);
+        }
+
+        // -----
+        // front
+        // -----
+
+        /**
+         * @return a reference to the first element
+         */
+        reference front () {
+            assert(!empty());
+            return _m[_f].d[_m[_f].b];
+        }
+
+        /**
+         * @return a const_reference to the first element
+         */
+        const_reference front () const {
+            assert(!empty());
+            return _m[_f].d[_m[_f].b];
+        }
+
+        // ------
+        // insert
+        // ------
+
+        /**
+         * @param p an iterator
+         * @param v a const_reference
+         * @return an iterator to the new element
+         * adds v before p, shifting only inside one block and splitting it first if it is full
+         */
+        iterator insert (iterator p, const_reference v) {
+            if (p == end()) {
+                push_back(v);
+                return end() - 1;
+            }
+            if (p == begin()) {
+                push_front(v);
+                return begin();
+            }
+            size_type  index = p.position();
+            value_type x(v);
+            size_type  k = p.k;
+            size_type  j = p.j;
+            if (_m[k].size() == TIER_WIDTH) {
+                split(k);
+                if (j >= _m[k].size()) {
+                    j -= _m[k].size();
+                    ++k;
+                }
+            }
+            traits_type::construct(_a, open(k, j), std::move(x));
+            ++_s;
+            assert(valid());
+            return at_index(index);
+        }
+
+        // ---
+        // pop
+        // ---
+
+        /**
+         * removes the last element
+         */
+        void pop_back () {
+            assert(!empty());
+            size_type k = _m.size() - 1;
+            traits_type::destroy(_a, _m[k].d + --_m[k].e);
+            add(k, -1);
+            --_s;
+            if (!_m[k].size()) {
+                settle(k);
+            }
+            assert(valid());
+        }
+
+        /**
+         * removes the first element
+         */
+        void pop_front () {
+            assert(!empty());
+            size_type k = _f;
+            traits_type::destroy(_a, _m[k].d + _m[k].b++);
+            add(k, -1);
+            --_s;
+            if (!_m[k].size()) {
+                settle(k);
+            }
+            assert(valid());
+        }
+
+        // ----
+        // push
+        // ----
+
+        /**
+         * @param v a const_reference
+         * adds v after the last element
+         */
+        void push_back (const_reference v) {
+            if (_m.size() == _f || _m.back().e == TIER_WIDTH) {
+                append_block();
+            }
+            traits_type::construct(_a, _m.back().d + _m.back().e, v);
+            ++_m.back().e;
+            add(_m.size() - 1, 1);
+            ++_s;
+            assert(valid());
+        }
+
+        /**
+         * @param v a const_reference
+         * adds v before the first element
+         */
+        void push_front (const_reference v) {
+            if (_m.size() == _f || _m[_f].b == 0) {
+                prepend_block();
+            }
+            traits_type::construct(_a, _m[_f].d + _m[_f].b - 1, v);
+            --_m[_f].b;
+            add(_f, 1);
+            ++_s;
+            assert(valid());
+        }
+
+        // ------
+        // resize
+        // ------
+
+        /**
+         * @param s a size_type
+         * @param v a const_reference
+         * resizes a MyTieredDeque so it contains s elements, filling with v
+         */
+        void resize (size_type s, const_reference v = value_type()) {
+            while (_s > s) {
+                pop_back();
+            }
+            while (_s < s) {
+                push_back(v);
+            }
+            assert(valid());
+        }
+
+        // ----
+        // size
+        // ----
+
+        /**
+         * @return a size_type
+         * gives the number of elements
+         */
+        size_type size () const {
+            return _s;
+        }
+
+        // ----
+        // swap
+        // ----
+
+        /**
+         * @param rhs a MyTieredDeque reference
+         * swaps the contents of two MyTieredDeque objects
+         */
+        void swap (MyTieredDeque& rhs) {
+            assert(_a == rhs._a);
+            _m.swap(rhs._m);
+            _t.swap(rhs._t);
+            std::swap(_f, rhs._f);
+            std::swap(_s, rhs._s);
+            std::swap(_spare, rhs._spare);
+            assert(valid());
+        }
+};
+
+#endif // TieredDeque_h